@@ -16,6 +16,88 @@ int hitboxCount = 0;
 void LoadAnimationFile(const char *filePath)
 {
     FileInfo info;
+#if !RETRO_USE_ORIGINAL_CODE
+    if (LoadFile(filePath, &info)) {
+        FileCursor cursor;
+        OpenFileCursor(&cursor);
+
+        char strBuf[0x21];
+        byte sheetIDs[0x18];
+        sheetIDs[0] = 0;
+
+        // Read & load each spritesheet
+        byte sheetCount = CursorReadByte(&cursor);
+        for (int s = 0; s < sheetCount; ++s) {
+            int length = CursorReadByte(&cursor);
+            if (length) {
+                int pathLen = length < (int)sizeof(strBuf) ? length : (int)sizeof(strBuf) - 1;
+                CursorRead(&cursor, strBuf, pathLen);
+                CursorSkip(&cursor, length - pathLen);
+                strBuf[pathLen] = 0;
+
+                // a buffered cursor has already closed the file, a streaming one has to make way for the sheet
+                if (!cursor.data) {
+                    GetFileInfo(&info);
+                    CloseFile();
+                }
+                sheetIDs[s] = AddGraphicsFile(strBuf);
+                if (!cursor.data)
+                    SetFileInfo(&info);
+            }
+        }
+
+        byte animCount          = CursorReadByte(&cursor);
+        AnimationFile *animFile = &animationFileList[animationFileCount];
+        animFile->animCount     = animCount;
+        animFile->aniListOffset = animationCount;
+
+        // Read animations
+        for (int a = 0; a < animCount; ++a) {
+            SpriteAnimation *anim = &animationList[animationCount++];
+            anim->frameListOffset = animFrameCount;
+            int length            = CursorReadByte(&cursor);
+            int nameLen           = length < (int)sizeof(anim->name) ? length : (int)sizeof(anim->name) - 1;
+            CursorRead(&cursor, anim->name, nameLen);
+            CursorSkip(&cursor, length - nameLen);
+            anim->name[nameLen] = 0;
+            anim->nameSymbol    = InternSymbol(anim->name);
+            anim->frameCount    = CursorReadByte(&cursor);
+            anim->speed         = CursorReadByte(&cursor);
+            anim->loopPoint     = CursorReadByte(&cursor);
+            anim->rotationStyle = CursorReadByte(&cursor);
+
+            for (int j = 0; j < anim->frameCount; ++j) {
+                SpriteFrame *frame = &animFrames[animFrameCount++];
+                frame->sheetID     = sheetIDs[CursorReadByte(&cursor)];
+                frame->hitboxID    = CursorReadByte(&cursor);
+                frame->sprX        = CursorReadByte(&cursor);
+                frame->sprY        = CursorReadByte(&cursor);
+                frame->width       = CursorReadByte(&cursor);
+                frame->height      = CursorReadByte(&cursor);
+                frame->pivotX      = (sbyte)CursorReadByte(&cursor);
+                frame->pivotY      = (sbyte)CursorReadByte(&cursor);
+            }
+
+            // 90 Degree (Extra rotation Frames) rotation
+            if (anim->rotationStyle == ROTSTYLE_STATICFRAMES)
+                anim->frameCount >>= 1;
+        }
+
+        // Read Hitboxes
+        animFile->hitboxListOffset = hitboxCount;
+        byte hitboxes              = CursorReadByte(&cursor);
+        for (int i = 0; i < hitboxes; ++i) {
+            Hitbox *hitbox = &hitboxList[hitboxCount++];
+            for (int d = 0; d < HITBOX_DIR_COUNT; ++d) {
+                hitbox->left[d]   = (sbyte)CursorReadByte(&cursor);
+                hitbox->top[d]    = (sbyte)CursorReadByte(&cursor);
+                hitbox->right[d]  = (sbyte)CursorReadByte(&cursor);
+                hitbox->bottom[d] = (sbyte)CursorReadByte(&cursor);
+            }
+        }
+        CloseFileCursor(&cursor);
+    }
+#else
     if (LoadFile(filePath, &info)) {
         byte fileBuffer = 0;
         char strBuf[0x21];
@@ -98,6 +180,7 @@ void LoadAnimationFile(const char *filePath)
 
         CloseFile();
     }
+#endif
 }
 void ClearAnimationData()
 {
@@ -24,6 +24,9 @@ struct SpriteAnimation {
     byte loopPoint;
     byte rotationStyle;
     int frameListOffset;
+#if !RETRO_USE_ORIGINAL_CODE
+    int nameSymbol;
+#endif
 };
 
 struct SpriteFrame {
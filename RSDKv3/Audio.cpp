@@ -44,6 +44,19 @@ SDL_AudioStream *ogv_stream;
 
 #define ADJUST_VOLUME(s, v) (s = (s * v) / MAX_VOLUME)
 
+#if !RETRO_USE_ORIGINAL_CODE
+char offlineAudioPath[0x100];
+bool offlineAudio = false;
+
+FileIO *offlineAudioFile    = NULL;
+short *offlineAudioBuffer   = NULL;
+int offlineAudioFrameRem    = 0;
+uint offlineAudioDataSize   = 0;
+uint offlineAudioFrameCount = 0;
+
+unsigned long long offlineAudioMixTicks = 0;
+#endif
+
 int InitAudioPlayback()
 {
     StopAllSfx(); //"init"
@@ -57,6 +70,25 @@ int InitAudioPlayback()
     want.channels = AUDIO_CHANNELS;
     want.callback = ProcessAudioPlayback;
 
+#if !RETRO_USE_ORIGINAL_CODE
+    if (offlineAudioPath[0]) {
+        // null sink: the device format is exactly what we asked for & the mixer is pulled by RetroEngine::Run
+        audioDeviceFormat = want;
+        if (!InitOfflineAudio()) {
+            audioEnabled = false;
+            return true; // no audio but game wont crash now
+        }
+        audioEnabled = true;
+
+#if RETRO_USING_SDL2_AUDIO
+        ogv_stream = SDL_NewAudioStream(AUDIO_F32SYS, 2, 48000, audioDeviceFormat.format, audioDeviceFormat.channels, audioDeviceFormat.freq);
+#endif
+
+        LoadGlobalSfx();
+        return true;
+    }
+#endif
+
 #if RETRO_USING_SDL2_AUDIO
     if ((audioDevice = SDL_OpenAudioDevice(nullptr, 0, &want, &audioDeviceFormat, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE)) > 0) {
         audioEnabled = true;
@@ -484,7 +516,7 @@ void ProcessAudioPlayback(void *userdata, unsigned char *stream, int len)
         }
 
         // Clamp mixed samples back to 16-bit and write them to the output buffer
-        for (size_t i = 0; i < sizeof(mix_buffer) / sizeof(*mix_buffer); ++i) {
+        for (size_t i = 0; i < samples_to_do; ++i) {
             const short max_audioval = ((1 << (16 - 1)) - 1);
             const short min_audioval = -(1 << (16 - 1));
 
@@ -502,6 +534,127 @@ void ProcessAudioPlayback(void *userdata, unsigned char *stream, int len)
     }
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+static void WriteOfflineAudioHeader()
+{
+    const uint channels   = AUDIO_CHANNELS;
+    const uint sampleRate = AUDIO_FREQUENCY;
+    const uint blockAlign = channels * sizeof(short);
+    const uint byteRate   = sampleRate * blockAlign;
+
+    byte header[44];
+    memcpy(&header[0], "RIFF", 4);
+    uint riffSize = 36 + offlineAudioDataSize;
+    header[4] = riffSize & 0xFF;
+    header[5] = (riffSize >> 8) & 0xFF;
+    header[6] = (riffSize >> 16) & 0xFF;
+    header[7] = (riffSize >> 24) & 0xFF;
+    memcpy(&header[8], "WAVEfmt ", 8);
+    header[16] = 16;
+    header[17] = 0;
+    header[18] = 0;
+    header[19] = 0;
+    header[20] = 1; // PCM
+    header[21] = 0;
+    header[22] = channels;
+    header[23] = 0;
+    header[24] = sampleRate & 0xFF;
+    header[25] = (sampleRate >> 8) & 0xFF;
+    header[26] = (sampleRate >> 16) & 0xFF;
+    header[27] = (sampleRate >> 24) & 0xFF;
+    header[28] = byteRate & 0xFF;
+    header[29] = (byteRate >> 8) & 0xFF;
+    header[30] = (byteRate >> 16) & 0xFF;
+    header[31] = (byteRate >> 24) & 0xFF;
+    header[32] = blockAlign;
+    header[33] = 0;
+    header[34] = 16; // bits per sample
+    header[35] = 0;
+    memcpy(&header[36], "data", 4);
+    header[40] = offlineAudioDataSize & 0xFF;
+    header[41] = (offlineAudioDataSize >> 8) & 0xFF;
+    header[42] = (offlineAudioDataSize >> 16) & 0xFF;
+    header[43] = (offlineAudioDataSize >> 24) & 0xFF;
+
+    fSeek(offlineAudioFile, 0, SEEK_SET);
+    fWrite(header, 1, sizeof(header), offlineAudioFile);
+}
+
+bool InitOfflineAudio()
+{
+    offlineAudioFile = fOpen(offlineAudioPath, "wb");
+    if (!offlineAudioFile) {
+        PrintLogCategory(LOGCAT_AUDIO, LOGLEVEL_ERROR, "Unable to open offline audio file: %s", offlineAudioPath);
+        return false;
+    }
+
+    // enough room for a single frame at the lowest refresh rate we'd reasonably tick at
+    offlineAudioBuffer = (short *)malloc(AUDIO_FREQUENCY * AUDIO_CHANNELS * sizeof(short));
+    if (!offlineAudioBuffer) {
+        fClose(offlineAudioFile);
+        offlineAudioFile = NULL;
+        return false;
+    }
+
+    offlineAudioFrameRem   = 0;
+    offlineAudioDataSize   = 0;
+    offlineAudioFrameCount = 0;
+    offlineAudioMixTicks   = 0;
+    offlineAudio           = true;
+
+    WriteOfflineAudioHeader(); // placeholder sizes, patched in ReleaseOfflineAudio
+    PrintLogCategory(LOGCAT_AUDIO, LOGLEVEL_INFO, "Rendering audio offline to: %s", offlineAudioPath);
+    return true;
+}
+
+void ProcessOfflineAudio()
+{
+    if (!offlineAudio || !offlineAudioFile)
+        return;
+
+    // pull exactly one engine frame worth of samples, carrying the remainder so no drift builds up over time
+    int refreshRate = Engine.refreshRate > 0 ? Engine.refreshRate : 60;
+    int frames      = AUDIO_FREQUENCY / refreshRate;
+    offlineAudioFrameRem += AUDIO_FREQUENCY % refreshRate;
+    if (offlineAudioFrameRem >= refreshRate) {
+        offlineAudioFrameRem -= refreshRate;
+        frames++;
+    }
+
+    int len = frames * AUDIO_CHANNELS * sizeof(short);
+
+    unsigned long long start = Time_GetPerformanceCounter();
+    ProcessAudioPlayback(NULL, (unsigned char *)offlineAudioBuffer, len);
+    offlineAudioMixTicks += Time_GetPerformanceCounter() - start;
+
+    fWrite(offlineAudioBuffer, 1, len, offlineAudioFile);
+    offlineAudioDataSize += len;
+    offlineAudioFrameCount++;
+}
+
+void ReleaseOfflineAudio()
+{
+    if (!offlineAudioFile)
+        return;
+
+    WriteOfflineAudioHeader();
+    fClose(offlineAudioFile);
+    offlineAudioFile = NULL;
+
+    if (offlineAudioBuffer)
+        free(offlineAudioBuffer);
+    offlineAudioBuffer = NULL;
+    offlineAudio       = false;
+
+    uint sampleCount = offlineAudioDataSize / (AUDIO_CHANNELS * sizeof(short));
+    double mixTime   = (double)offlineAudioMixTicks / (double)Time_GetPerformanceFrequency();
+    PrintLogCategory(LOGCAT_AUDIO, LOGLEVEL_INFO, "Offline audio: %u frames, %u samples (%.2fs of audio) mixed in %.3fs", offlineAudioFrameCount, sampleCount,
+                     (double)sampleCount / AUDIO_FREQUENCY, mixTime);
+    if (offlineAudioFrameCount)
+        PrintLogCategory(LOGCAT_AUDIO, LOGLEVEL_INFO, "Offline audio: %.3fms mix time per frame", (mixTime * 1000.0) / offlineAudioFrameCount);
+}
+#endif
+
 void ProcessAudioMixing(int *dst, const short *src, int len, int volume, char pan)
 {
     if (volume == 0)
@@ -786,5 +939,9 @@ void ReleaseAudioDevice()
     ReleaseStageSfx();
     ReleaseGlobalSfx();
 
+#if !RETRO_USE_ORIGINAL_CODE
+    ReleaseOfflineAudio();
+#endif
+
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
 }
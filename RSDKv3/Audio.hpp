@@ -111,6 +111,12 @@ extern StreamInfo *streamInfoPtr;
 extern SDL_AudioSpec audioDeviceFormat;
 #endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+// Offline render: when set, no audio device is opened and the mixer output is written to this WAV file instead
+extern char offlineAudioPath[0x100];
+extern bool offlineAudio;
+#endif
+
 int InitAudioPlayback();
 void LoadGlobalSfx();
 
@@ -118,6 +124,12 @@ void ProcessMusicStream(int *stream, size_t bytes_wanted);
 void ProcessAudioPlayback(void *userdata, unsigned char *stream, int len);
 void ProcessAudioMixing(int *dst, const short *src, int len, int volume, char pan);
 
+#if !RETRO_USE_ORIGINAL_CODE
+bool InitOfflineAudio();
+void ProcessOfflineAudio();
+void ReleaseOfflineAudio();
+#endif
+
 inline void FreeMusInfo()
 {
     LockAudioDevice();
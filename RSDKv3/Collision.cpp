@@ -3037,10 +3037,10 @@ void EnemyCollision(int left, int top, int right, int bottom)
     int hammerHitboxBottom = 0;
 
 #if !RETRO_USE_ORIGINAL_CODE
-    bool miniPlayerFlag = GetGlobalVariableByName("Mini_PlayerFlag");
-    sbyte playerAmy     = GetGlobalVariableByName("PLAYER_AMY") ? GetGlobalVariableByName("PLAYER_AMY") : 5;
-    sbyte aniHammerJump = GetGlobalVariableByName("ANI_HAMMER_JUMP") ? GetGlobalVariableByName("ANI_HAMMER_JUMP") : 45;
-    sbyte aniHammerDash = GetGlobalVariableByName("ANI_HAMMER_DASH") ? GetGlobalVariableByName("ANI_HAMMER_DASH") : 46;
+    bool miniPlayerFlag = GetGlobalVariableBySymbol(SYMBOL_MINI_PLAYERFLAG);
+    sbyte playerAmy     = GetGlobalVariableBySymbol(SYMBOL_PLAYER_AMY) ? GetGlobalVariableBySymbol(SYMBOL_PLAYER_AMY) : 5;
+    sbyte aniHammerJump = GetGlobalVariableBySymbol(SYMBOL_ANI_HAMMER_JUMP) ? GetGlobalVariableBySymbol(SYMBOL_ANI_HAMMER_JUMP) : 45;
+    sbyte aniHammerDash = GetGlobalVariableBySymbol(SYMBOL_ANI_HAMMER_DASH) ? GetGlobalVariableBySymbol(SYMBOL_ANI_HAMMER_DASH) : 46;
 #else
     bool mini_PlayerFlag = globalVariables[62];
     sbyte playerAmy      = 5;
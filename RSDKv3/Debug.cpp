@@ -2,14 +2,319 @@
 
 #include <cstdarg>
 
+#if !RETRO_USE_ORIGINAL_CODE
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <csignal>
+#endif
+
 #if RETRO_PLATFORM == RETRO_ANDROID
 #include <android/log.h>
 #endif
 
 int touchFlags = 0;
 
+#if !RETRO_USE_ORIGINAL_CODE
+#define STATETRACE_SIGNATURE    (0x43525452) // "RTRC"
+#define STATETRACE_VERSION      (1)
+#define STATETRACE_BUCKET_SLOTS ((ENTITY_COUNT + STATETRACE_ENTITY_BUCKETS - 1) / STATETRACE_ENTITY_BUCKETS)
+
+char stateTracePath[0x100] = "";
+bool stateTraceFrameBuffer = false;
+bool stateTraceActive      = false;
+
+FileIO *stateTraceFile = NULL;
+uint stateTraceFrame   = 0;
+
+// Shadow copy of the entity list, so only slots whose bytes changed since the last tick get rehashed
+Entity *traceEntityShadow = NULL;
+uint *traceEntityHashes   = NULL;
+uint traceEntityBuckets[STATETRACE_ENTITY_BUCKETS];
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+#define LOG_RING_SIZE         (0x200) // must be a power of two
+#define LOG_MESSAGE_SIZE      (0x100)
+#define LOG_WRITE_INTERVAL_MS (50)
+
+struct LogEntry {
+    std::atomic<uint> sequence; // the slot's lap base while free, lap base + 1 once a message is in it
+    byte category;
+    ushort length;
+    char text[LOG_MESSAGE_SIZE];
+};
+
+// Producers claim slots with a CAS on logWritePos and never block; a full ring drops the message instead
+LogEntry logRing[LOG_RING_SIZE];
+std::atomic<uint> logWritePos;
+uint logReadPos = 0;
+std::atomic<uint> logDropCount;
+
+// The last message written, only touched by whoever holds logDrainMutex. Repeats are collapsed on the writer side
+int logLastCategory = -1;
+int logLastLength   = 0;
+char logLastText[LOG_MESSAGE_SIZE];
+int logRepeatCount = 0;
+
+std::atomic<bool> logWriterActive;
+bool logWriterQuit    = false;
+bool logWriterClosed  = false;
+bool logHandlersAdded = false;
+std::mutex logWriterMutex;
+std::mutex logDrainMutex;
+std::condition_variable logWriterCond;
+std::thread logWriterThread;
+
+const char *logCategoryNames[LOGCAT_COUNT] = { "", "[Script] ", "[Audio] ", "[File] " };
+
+static void GetLogPath(char *pathBuffer)
+{
+#if RETRO_PLATFORM == RETRO_OSX || RETRO_PLATFORM == RETRO_UWP
+    if (!usingCWD)
+#if RETRO_PLATFORM == RETRO_OSX
+    {
+        char logBuffer[0x100];
+        getResourcesPath(logBuffer, sizeof(logBuffer));
+        sprintf(pathBuffer, "%s/log.txt", logBuffer);
+    }
+#else
+        sprintf(pathBuffer, "%s/log.txt", getResourcesPath());
+#endif
+    else
+        sprintf(pathBuffer, "log.txt");
+#elif RETRO_PLATFORM == RETRO_ANDROID
+    sprintf(pathBuffer, "%s/log.txt", gamePath);
+#else
+    sprintf(pathBuffer, BASE_PATH "log.txt");
+#endif
+}
+
+static bool PushLogEntry(int category, const char *text, int length)
+{
+    uint pos        = logWritePos.load(std::memory_order_relaxed);
+    LogEntry *entry = NULL;
+    while (true) {
+        entry    = &logRing[pos & (LOG_RING_SIZE - 1)];
+        int diff = (int)(entry->sequence.load(std::memory_order_acquire) - (pos & ~(LOG_RING_SIZE - 1)));
+        if (diff == 0) {
+            if (logWritePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0) {
+            // the writer hasn't freed this slot from the last lap yet
+            logDropCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else {
+            pos = logWritePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    entry->category = category;
+    entry->length   = length;
+    memcpy(entry->text, text, length);
+    entry->sequence.store((pos & ~(LOG_RING_SIZE - 1)) + 1, std::memory_order_release);
+
+    // repeats are only collapsed once written, so wake the writer early when a burst has filled half the ring
+    if (!(pos & (LOG_RING_SIZE / 2 - 1)) && pos)
+        logWriterCond.notify_one();
+    return true;
+}
+
+static void WriteLogText(FileIO *file, int category, const char *text, int length)
+{
+    printf("%s%.*s\n", logCategoryNames[category], length, text);
+#if RETRO_PLATFORM == RETRO_ANDROID
+    __android_log_print(ANDROID_LOG_INFO, "RSDKv3", "%s%.*s", logCategoryNames[category], length, text);
+#endif
+    if (file) {
+        fWrite(logCategoryNames[category], 1, StrLength(logCategoryNames[category]), file);
+        fWrite(text, 1, length, file);
+        fWrite("\n", 1, 1, file);
+    }
+}
+
+static FileIO *OpenLogFile(FileIO *file)
+{
+    if (!file) {
+        char pathBuffer[0x100];
+        GetLogPath(pathBuffer);
+        file = fOpen(pathBuffer, "a");
+    }
+    return file;
+}
+
+static void WriteLogRepeats(FileIO *file)
+{
+    if (logRepeatCount) {
+        char repeatBuffer[0x40];
+        sprintf(repeatBuffer, "(previous message repeated %d times)", logRepeatCount);
+        WriteLogText(file, LOGCAT_ENGINE, repeatBuffer, StrLength(repeatBuffer));
+        logRepeatCount = 0;
+    }
+}
+
+// Caller holds logDrainMutex. The file is opened once per batch rather than once per message.
+// A pending repeat count carries over between batches and is only written out when a different message arrives or on flush
+static void DrainLogEntries(bool flush)
+{
+    FileIO *file = NULL;
+    while (true) {
+        uint lapBase    = logReadPos & ~(LOG_RING_SIZE - 1);
+        LogEntry *entry = &logRing[logReadPos & (LOG_RING_SIZE - 1)];
+        if (entry->sequence.load(std::memory_order_acquire) != lapBase + 1)
+            break;
+
+        if (entry->category == logLastCategory && entry->length == logLastLength && !memcmp(entry->text, logLastText, entry->length)) {
+            ++logRepeatCount;
+        }
+        else {
+            file = OpenLogFile(file);
+            WriteLogRepeats(file);
+            WriteLogText(file, entry->category, entry->text, entry->length);
+            logLastCategory = entry->category;
+            logLastLength   = entry->length;
+            memcpy(logLastText, entry->text, entry->length);
+        }
+
+        entry->sequence.store(lapBase + LOG_RING_SIZE, std::memory_order_release);
+        ++logReadPos;
+    }
+
+    if (flush && logRepeatCount) {
+        file = OpenLogFile(file);
+        WriteLogRepeats(file);
+    }
+
+    uint dropped = logDropCount.exchange(0, std::memory_order_relaxed);
+    if (dropped) {
+        char buffer[0x40];
+        sprintf(buffer, "%u log messages dropped, the log ring was full", dropped);
+        file = OpenLogFile(file);
+        WriteLogText(file, LOGCAT_ENGINE, buffer, StrLength(buffer));
+    }
+
+    if (file)
+        fClose(file);
+}
+
+static void DrainLog(bool flush)
+{
+    std::lock_guard<std::mutex> lock(logDrainMutex);
+    DrainLogEntries(flush);
+}
+
+static void ProcessLogWrites()
+{
+    std::unique_lock<std::mutex> lock(logWriterMutex);
+    while (!logWriterQuit) {
+        lock.unlock();
+        DrainLog(false);
+        lock.lock();
+        if (!logWriterQuit)
+            logWriterCond.wait_for(lock, std::chrono::milliseconds(LOG_WRITE_INTERVAL_MS));
+    }
+}
+
+#if RETRO_PLATFORM != RETRO_3DS
+static void LogCrashHandler(int sig)
+{
+    // best effort, the game thread may have died holding the drain lock
+    if (logDrainMutex.try_lock()) {
+        DrainLogEntries(true);
+        logDrainMutex.unlock();
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+#endif
+
+static void StartLogWriter()
+{
+    std::lock_guard<std::mutex> lock(logWriterMutex);
+    if (logWriterActive.load() || logWriterClosed)
+        return;
+
+    if (!logHandlersAdded) {
+        // runs before the static thread object is destroyed, so exiting without Engine.Run returning still joins it
+        atexit(ReleaseLogWriter);
+#if RETRO_PLATFORM != RETRO_3DS
+        signal(SIGSEGV, LogCrashHandler);
+        signal(SIGABRT, LogCrashHandler);
+        signal(SIGFPE, LogCrashHandler);
+        signal(SIGILL, LogCrashHandler);
+#endif
+        logHandlersAdded = true;
+    }
+
+    logWriterQuit   = false;
+    logWriterThread = std::thread(ProcessLogWrites);
+    logWriterActive.store(true, std::memory_order_release);
+}
+
+static void PrintLogArgs(int category, int level, const char *msg, va_list args)
+{
+    if (!engineDebugMode || level < Engine.logLevel)
+        return;
+
+    char buffer[LOG_MESSAGE_SIZE];
+    int length = vsnprintf(buffer, sizeof(buffer), msg, args);
+    if (length < 0)
+        return;
+    if (length >= (int)sizeof(buffer))
+        length = sizeof(buffer) - 1;
+
+    PushLogEntry(category, buffer, length);
+
+    if (!logWriterActive.load(std::memory_order_acquire)) {
+        if (logWriterClosed)
+            DrainLog(true);
+        else
+            StartLogWriter();
+    }
+}
+
+void PrintLogCategory(int category, int level, const char *msg, ...)
+{
+    va_list args;
+    va_start(args, msg);
+    PrintLogArgs(category, level, msg, args);
+    va_end(args);
+}
+
+void ReleaseLogWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(logWriterMutex);
+        logWriterQuit   = true;
+        logWriterClosed = true;
+        logWriterActive.store(false, std::memory_order_release);
+        logWriterCond.notify_all();
+    }
+    if (logWriterThread.joinable())
+        logWriterThread.join();
+
+    DrainLog(true);
+}
+#endif
+
 void PrintLog(const char *msg, ...)
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    int level = LOGLEVEL_INFO;
+    if (strncmp(msg, "ERROR", 5) == 0)
+        level = LOGLEVEL_ERROR;
+    else if (strncmp(msg, "WARNING", 7) == 0)
+        level = LOGLEVEL_WARNING;
+
+    va_list args;
+    va_start(args, msg);
+    PrintLogArgs(LOGCAT_ENGINE, level, msg, args);
+    va_end(args);
+#else
     if (engineDebugMode) {
         char buffer[0x100];
 
@@ -46,12 +351,13 @@ void PrintLog(const char *msg, ...)
             fClose(file);
         }
     }
+#endif
 }
 
 void InitDevMenu()
 {
 #if RETRO_USE_MOD_LOADER
-    for (int m = 0; m < modList.size(); ++m) ScanModFolder(&modList[m]);
+    RefreshModFileMap();
 #endif
     xScrollOffset  = 0;
     yScrollOffset  = 0;
@@ -629,6 +935,7 @@ void ProcessStageSelect()
             char buffer[0x100];
             if (gameMenu[1].selection1 < modList.size() && (keyPress.A || keyPress.start || keyPress.left || keyPress.right)) {
                 modList[gameMenu[1].selection1].active ^= 1;
+                modFileMapDirty = true;
                 StrCopy(buffer, modList[gameMenu[1].selection1].name.c_str());
                 StrAdd(buffer, ": ");
                 StrAdd(buffer, (modList[gameMenu[1].selection1].active ? "  Active" : "Inactive"));
@@ -641,6 +948,7 @@ void ProcessStageSelect()
                 ModInfo swap       = modList[preOption];
                 modList[preOption] = modList[option];
                 modList[option]    = swap;
+                modFileMapDirty    = true;
 
                 SetupTextMenu(&gameMenu[0], 0);
                 AddTextMenuEntry(&gameMenu[0], "MOD LIST");
@@ -718,3 +1026,195 @@ void ProcessStageSelect()
         }
     }
 }
+
+#if !RETRO_USE_ORIGINAL_CODE
+static inline uint GetEntitySlotHash(int slot)
+{
+    uint hash = HashStateBytes(STATEHASH_SEED, &slot, sizeof(slot));
+    return HashStateBytes(hash, &objectEntityList[slot], ENTITY_HASHSIZE);
+}
+
+bool InitStateTrace()
+{
+    stateTraceFile = fOpen(stateTracePath, "wb");
+    if (!stateTraceFile) {
+        PrintLog("Unable to open state trace file: %s", stateTracePath);
+        return false;
+    }
+
+    traceEntityShadow = (Entity *)malloc(ENTITY_COUNT * sizeof(Entity));
+    traceEntityHashes = (uint *)malloc(ENTITY_COUNT * sizeof(uint));
+    if (!traceEntityShadow || !traceEntityHashes) {
+        ReleaseStateTrace();
+        return false;
+    }
+
+    // bucket hashes are sums of slot hashes, so a changed slot can be swapped out without touching the others
+    memset(traceEntityBuckets, 0, sizeof(traceEntityBuckets));
+    for (int e = 0; e < ENTITY_COUNT; ++e) {
+        memcpy(&traceEntityShadow[e], &objectEntityList[e], sizeof(Entity));
+        traceEntityHashes[e] = GetEntitySlotHash(e);
+        traceEntityBuckets[e / STATETRACE_BUCKET_SLOTS] += traceEntityHashes[e];
+    }
+
+    uint header[3];
+    header[0] = STATETRACE_SIGNATURE;
+    header[1] = STATETRACE_VERSION;
+    header[2] = stateTraceFrameBuffer;
+    fWrite(header, sizeof(uint), 3, stateTraceFile);
+
+    stateTraceFrame  = 0;
+    stateTraceActive = true;
+    PrintLog("Writing state trace to: %s", stateTracePath);
+    return true;
+}
+
+void ProcessStateTrace()
+{
+    if (!stateTraceActive)
+        return;
+
+    StateTraceFrame trace;
+    trace.frame = stateTraceFrame++;
+
+    for (int e = 0; e < ENTITY_COUNT; ++e) {
+        if (memcmp(&traceEntityShadow[e], &objectEntityList[e], ENTITY_HASHSIZE)) {
+            memcpy(&traceEntityShadow[e], &objectEntityList[e], ENTITY_HASHSIZE);
+            uint hash = GetEntitySlotHash(e);
+            traceEntityBuckets[e / STATETRACE_BUCKET_SLOTS] += hash - traceEntityHashes[e];
+            traceEntityHashes[e] = hash;
+        }
+    }
+    memcpy(trace.entities, traceEntityBuckets, sizeof(trace.entities));
+
+    trace.players = GetPlayerStateHash(STATEHASH_SEED);
+    trace.globals = HashStateBytes(STATEHASH_SEED, globalVariables, globalVariablesCount * sizeof(int));
+
+    int camera[] = { cameraTarget,  cameraStyle, cameraEnabled, cameraAdjustY, xScrollOffset, yScrollOffset, xScrollA, xScrollB,
+                     yScrollA,      yScrollB,    yScrollMove,   cameraShakeX,  cameraShakeY,  cameraLag,     cameraLagStyle };
+    trace.camera = HashStateBytes(STATEHASH_SEED, camera, sizeof(camera));
+
+    trace.frameBuffer = 0;
+    if (stateTraceFrameBuffer && Engine.frameBuffer) {
+        // word-wise rather than per byte, this is by far the largest thing hashed
+        const uint *pixels = (const uint *)Engine.frameBuffer;
+        int count          = (GFX_LINESIZE * SCREEN_YSIZE) / 2;
+        uint hash          = STATEHASH_SEED;
+        for (int i = 0; i < count; ++i) hash = (hash ^ pixels[i]) * 0x01000193;
+        trace.frameBuffer = hash;
+    }
+
+    fWrite(&trace, sizeof(StateTraceFrame), 1, stateTraceFile);
+}
+
+void ReleaseStateTrace()
+{
+    if (stateTraceFile) {
+        fClose(stateTraceFile);
+        PrintLog("State trace: %u frames written", stateTraceFrame);
+    }
+    stateTraceFile = NULL;
+
+    if (traceEntityShadow)
+        free(traceEntityShadow);
+    if (traceEntityHashes)
+        free(traceEntityHashes);
+    traceEntityShadow = NULL;
+    traceEntityHashes = NULL;
+    stateTraceActive  = false;
+}
+
+static FileIO *OpenStateTrace(const char *path, uint *flags)
+{
+    FileIO *file = fOpen(path, "rb");
+    if (!file) {
+        PrintLog("Unable to open state trace: %s", path);
+        return NULL;
+    }
+
+    uint header[3];
+    if (fRead(header, sizeof(uint), 3, file) != 3 || header[0] != STATETRACE_SIGNATURE || header[1] != STATETRACE_VERSION) {
+        PrintLog("Invalid state trace: %s", path);
+        fClose(file);
+        return NULL;
+    }
+    *flags = header[2];
+    return file;
+}
+
+// Tool mode: returns 0 if the traces match, 1 if they diverge and 2 if either can't be read
+int CompareStateTraces(const char *pathA, const char *pathB)
+{
+    uint flagsA = 0, flagsB = 0;
+    FileIO *fileA = OpenStateTrace(pathA, &flagsA);
+    FileIO *fileB = OpenStateTrace(pathB, &flagsB);
+    if (!fileA || !fileB) {
+        if (fileA)
+            fClose(fileA);
+        if (fileB)
+            fClose(fileB);
+        return 2;
+    }
+
+    bool compareFB = flagsA && flagsB;
+    if (flagsA != flagsB)
+        PrintLog("Only one trace has frame buffer hashes, skipping them");
+
+    StateTraceFrame a, b;
+    uint frames = 0;
+    int result  = 0;
+    while (true) {
+        bool hasA = fRead(&a, sizeof(StateTraceFrame), 1, fileA) == 1;
+        bool hasB = fRead(&b, sizeof(StateTraceFrame), 1, fileB) == 1;
+        if (!hasA || !hasB) {
+            if (hasA != hasB) {
+                PrintLog("Traces match for %u frames, then %s ends early", frames, hasA ? pathB : pathA);
+                result = 1;
+            }
+            break;
+        }
+
+        bool diverged = false;
+        for (int i = 0; i < STATETRACE_ENTITY_BUCKETS; ++i) {
+            if (a.entities[i] != b.entities[i]) {
+                int first = i * STATETRACE_BUCKET_SLOTS;
+                int last  = first + STATETRACE_BUCKET_SLOTS - 1;
+                if (last >= ENTITY_COUNT)
+                    last = ENTITY_COUNT - 1;
+                PrintLog("Frame %u: objectEntityList[%d..%d] differs", a.frame, first, last);
+                diverged = true;
+            }
+        }
+        if (a.players != b.players) {
+            PrintLog("Frame %u: playerList differs", a.frame);
+            diverged = true;
+        }
+        if (a.globals != b.globals) {
+            PrintLog("Frame %u: globalVariables differ", a.frame);
+            diverged = true;
+        }
+        if (a.camera != b.camera) {
+            PrintLog("Frame %u: camera/scroll values differ", a.frame);
+            diverged = true;
+        }
+        if (compareFB && a.frameBuffer != b.frameBuffer) {
+            PrintLog("Frame %u: frame buffer differs", a.frame);
+            diverged = true;
+        }
+
+        if (diverged) {
+            PrintLog("Traces first diverge at frame %u", a.frame);
+            result = 1;
+            break;
+        }
+        ++frames;
+    }
+
+    if (!result)
+        PrintLog("Traces match (%u frames)", frames);
+
+    fClose(fileA);
+    fClose(fileB);
+    return result;
+}
+#endif
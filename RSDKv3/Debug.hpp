@@ -3,6 +3,28 @@
 
 void PrintLog(const char *msg, ...);
 
+#if !RETRO_USE_ORIGINAL_CODE
+enum LogLevels {
+    LOGLEVEL_DEBUG,
+    LOGLEVEL_INFO,
+    LOGLEVEL_WARNING,
+    LOGLEVEL_ERROR,
+};
+
+enum LogCategories {
+    LOGCAT_ENGINE,
+    LOGCAT_SCRIPT,
+    LOGCAT_AUDIO,
+    LOGCAT_FILE,
+    LOGCAT_COUNT,
+};
+
+// PrintLog uses LOGCAT_ENGINE and picks the level from an "ERROR"/"WARNING" prefix
+void PrintLogCategory(int category, int level, const char *msg, ...);
+// Stops the writer thread and writes out anything still queued; later messages are written synchronously
+void ReleaseLogWriter();
+#endif
+
 enum DevMenuMenus {
     DEVMENU_MAIN,
     DEVMENU_PLAYERSEL,
@@ -18,4 +40,27 @@ void InitDevMenu();
 void InitErrorMessage();
 void ProcessStageSelect();
 
+#if !RETRO_USE_ORIGINAL_CODE
+#define STATETRACE_ENTITY_BUCKETS (0x10)
+
+// One record per logic tick, written as-is to the trace file
+struct StateTraceFrame {
+    uint frame;
+    uint entities[STATETRACE_ENTITY_BUCKETS]; // each bucket covers a contiguous range of entity slots
+    uint players;
+    uint globals;
+    uint camera;
+    uint frameBuffer;
+};
+
+extern char stateTracePath[0x100];
+extern bool stateTraceFrameBuffer;
+extern bool stateTraceActive;
+
+bool InitStateTrace();
+void ProcessStateTrace();
+void ReleaseStateTrace();
+int CompareStateTraces(const char *pathA, const char *pathB);
+#endif
+
 #endif //! DEBUG_H
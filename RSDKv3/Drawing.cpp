@@ -19,14 +19,44 @@
 // it rather than remove it outright.
 #define DONT_USE_VIEW_ANGLE (1)
 
-ushort blendLookupTable[0x100 * 0x20];
-ushort subtractLookupTable[0x100 * 0x20];
-ushort tintLookupTable[0x10000];
-
 // Extras used in blending
 #define maxVal(a, b) (a >= b ? a : b)
 #define minVal(a, b) (a <= b ? a : b)
 
+#if RETRO_USE_CONSTEXPR_TABLES
+constexpr std::array<ushort, 0x100 * 0x20> GenerateBlendTable(bool subtract)
+{
+    std::array<ushort, 0x100 * 0x20> table = {};
+    for (int y = 0; y < 0x100; y++) {
+        for (int x = 0; x < 0x20; x++) {
+            if (subtract)
+                table[x + (0x20 * y)] = y * (0x1F - x) >> 8;
+            else
+                table[x + (0x20 * y)] = y * x >> 8;
+        }
+    }
+    return table;
+}
+
+constexpr std::array<ushort, 0x10000> GenerateTintTable()
+{
+    std::array<ushort, 0x10000> table = {};
+    for (int i = 0; i < 0x10000; i++) {
+        int tintValue = ((i & 0x1F) + ((i & 0x7E0) >> 6) + ((i & 0xF800) >> 11)) / 3 + 6;
+        table[i]      = 0x841 * minVal(tintValue, 0x1F);
+    }
+    return table;
+}
+
+constexpr std::array<ushort, 0x100 * 0x20> blendLookupTable    = GenerateBlendTable(false);
+constexpr std::array<ushort, 0x100 * 0x20> subtractLookupTable = GenerateBlendTable(true);
+constexpr std::array<ushort, 0x10000> tintLookupTable          = GenerateTintTable();
+#else
+ushort blendLookupTable[0x100 * 0x20];
+ushort subtractLookupTable[0x100 * 0x20];
+ushort tintLookupTable[0x10000];
+#endif
+
 int SCREEN_XSIZE        = 424;
 int SCREEN_CENTERX      = 424 / 2;
 int SCREEN_XSIZE_CONFIG = 424;
@@ -98,6 +128,118 @@ bool integerScaling = false;
 bool disableEnhancedScaling = false;
 // enable bilinear scaling, which just disables the fancy upscaling that enhanced scaling does.
 bool bilinearScaling = false;
+
+#if RETRO_USING_SDL2 && !RETRO_USING_OPENGL
+// enhanced scaling target, kept alive between frames and only rebuilt when the window or scaling settings change
+struct ScalingTarget {
+    SDL_Texture *texture;
+    SDL_Rect dest;
+    int windowXSize;
+    int windowYSize;
+    int screenXSize;
+    int screenYSize;
+    int scalingMode;
+    bool integerScaling;
+    bool bilinearScaling;
+    bool valid;
+    int logicalXSize;
+    int logicalYSize;
+};
+
+ScalingTarget scalingTarget;
+
+void ReleaseScalingTarget()
+{
+    if (scalingTarget.texture)
+        SDL_DestroyTexture(scalingTarget.texture);
+    scalingTarget.texture      = NULL;
+    scalingTarget.valid        = false;
+    scalingTarget.logicalXSize = 0;
+    scalingTarget.logicalYSize = 0;
+}
+
+void SetScalingLogicalSize(int width, int height)
+{
+    if (scalingTarget.logicalXSize == width && scalingTarget.logicalYSize == height)
+        return;
+
+    SDL_RenderSetLogicalSize(Engine.renderer, width, height);
+    scalingTarget.logicalXSize = width;
+    scalingTarget.logicalYSize = height;
+}
+
+// returns true if the enhanced scaling target should be used for the current window
+bool UpdateScalingTarget()
+{
+    if (scalingTarget.valid && scalingTarget.windowXSize == Engine.windowXSize && scalingTarget.windowYSize == Engine.windowYSize
+        && scalingTarget.screenXSize == SCREEN_XSIZE && scalingTarget.screenYSize == SCREEN_YSIZE && scalingTarget.scalingMode == Engine.scalingMode
+        && scalingTarget.integerScaling == integerScaling && scalingTarget.bilinearScaling == bilinearScaling)
+        return scalingTarget.texture != NULL;
+
+    if (scalingTarget.texture)
+        SDL_DestroyTexture(scalingTarget.texture);
+    scalingTarget.texture         = NULL;
+    scalingTarget.valid           = true;
+    scalingTarget.windowXSize     = Engine.windowXSize;
+    scalingTarget.windowYSize     = Engine.windowYSize;
+    scalingTarget.screenXSize     = SCREEN_XSIZE;
+    scalingTarget.screenYSize     = SCREEN_YSIZE;
+    scalingTarget.scalingMode     = Engine.scalingMode;
+    scalingTarget.integerScaling  = integerScaling;
+    scalingTarget.bilinearScaling = bilinearScaling;
+
+    float screenxsize = SCREEN_XSIZE;
+    float screenysize = SCREEN_YSIZE;
+
+    // check if enhanced scaling is even necessary to be calculated by checking if the screen size is close enough on one axis
+    // unfortunately it has to be "close enough" because of floating point precision errors. dang it
+    if (Engine.scalingMode == 2) {
+        bool cond1 = std::round((Engine.windowXSize / screenxsize) * 24) / 24 == std::floor(Engine.windowXSize / screenxsize);
+        bool cond2 = std::round((Engine.windowYSize / screenysize) * 24) / 24 == std::floor(Engine.windowYSize / screenysize);
+        if (cond1 || cond2)
+            disableEnhancedScaling = true;
+    }
+
+    if (Engine.scalingMode == 0 || disableEnhancedScaling)
+        return false;
+
+    // set up integer scaled texture, which is scaled to the largest integer scale of the screen buffer
+    // before you make a texture that's larger than the window itself. This texture will then be scaled
+    // up to the actual screen size using linear interpolation. This makes even window/screen scales
+    // nice and sharp, and uneven scales as sharp as possible without creating wonky pixel scales,
+    // creating a nice image.
+
+    // get integer scale
+    float scale = 1;
+    if (!bilinearScaling) {
+        scale = std::fminf(std::floor((float)Engine.windowXSize / (float)SCREEN_XSIZE), std::floor((float)Engine.windowYSize / (float)SCREEN_YSIZE));
+        if (scale < 1)
+            scale = 1;
+    }
+    // the scale quality hint is only read when a texture is created, so only hold it at linear for that
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+    scalingTarget.texture =
+        SDL_CreateTexture(Engine.renderer, SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_TARGET, SCREEN_XSIZE * scale, SCREEN_YSIZE * scale);
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+    if (!scalingTarget.texture) {
+        PrintLog("Failed to create scaling target: %s", SDL_GetError());
+        return false;
+    }
+
+    // keep aspect
+    float aspectScale = std::fminf(Engine.windowYSize / screenysize, Engine.windowXSize / screenxsize);
+    if (integerScaling) {
+        aspectScale = std::floor(aspectScale);
+    }
+    float xoffset        = (Engine.windowXSize - (screenxsize * aspectScale)) / 2;
+    float yoffset        = (Engine.windowYSize - (screenysize * aspectScale)) / 2;
+    scalingTarget.dest.x = std::round(xoffset);
+    scalingTarget.dest.y = std::round(yoffset);
+    scalingTarget.dest.w = std::round(screenxsize * aspectScale);
+    scalingTarget.dest.h = std::round(screenysize * aspectScale);
+    return true;
+}
+#endif
 #endif
 
 static inline unsigned int ceilPowerOfTwo(unsigned int x) {
@@ -342,12 +484,14 @@ int InitRenderDevice()
     retroBuffer = Gfx_TextureCreate(ceilPowerOfTwo(SCREEN_XSIZE), ceilPowerOfTwo(SCREEN_YSIZE), false, false);
     Gfx_TextureSetFilter(retroBuffer, Engine.scalingMode ? true : false);
 
+#if !RETRO_USE_CONSTEXPR_TABLES
     for (int c = 0; c < 0x10000; ++c) {
         int r               = (c & 0b1111100000000000) >> 8;
         int g               = (c & 0b0000011111100000) >> 3;
         int b               = (c & 0b0000000000011111) << 3;
         gfxPalette16to32[c] = (r << 24) | (g << 16) | (b << 8) | (0xFF << 0);
     }
+#endif
     SetScreenDimensions(SCREEN_XSIZE, SCREEN_YSIZE, SCREEN_XSIZE * Engine.windowScale, SCREEN_YSIZE * Engine.windowScale);
 #endif
 
@@ -441,51 +585,19 @@ void FlipScreen()
         }
 
         SDL_GetWindowSize(Engine.window, &Engine.windowXSize, &Engine.windowYSize);
-        float screenxsize = SCREEN_XSIZE;
-        float screenysize = SCREEN_YSIZE;
-
-        // check if enhanced scaling is even necessary to be calculated by checking if the screen size is close enough on one axis
-        // unfortunately it has to be "close enough" because of floating point precision errors. dang it
-        if (Engine.scalingMode == 2) {
-            bool cond1 = std::round((Engine.windowXSize / screenxsize) * 24) / 24 == std::floor(Engine.windowXSize / screenxsize);
-            bool cond2 = std::round((Engine.windowYSize / screenysize) * 24) / 24 == std::floor(Engine.windowYSize / screenysize);
-            if (cond1 || cond2)
-                disableEnhancedScaling = true;
-        }
-
-        if ((Engine.scalingMode != 0 && !disableEnhancedScaling) && Engine.gameMode != ENGINE_VIDEOWAIT) {
-            // set up integer scaled texture, which is scaled to the largest integer scale of the screen buffer
-            // before you make a texture that's larger than the window itself. This texture will then be scaled
-            // up to the actual screen size using linear interpolation. This makes even window/screen scales
-            // nice and sharp, and uneven scales as sharp as possible without creating wonky pixel scales,
-            // creating a nice image.
-
-            // get integer scale
-            float scale = 1;
-            if (!bilinearScaling) {
-                scale = std::fminf(std::floor((float)Engine.windowXSize / (float)SCREEN_XSIZE),
-                                   std::floor((float)Engine.windowYSize / (float)SCREEN_YSIZE));
-            }
-            SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear"); // set interpolation to linear
-            // create texture that's integer scaled.
-            texTarget =
-                SDL_CreateTexture(Engine.renderer, SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_TARGET, SCREEN_XSIZE * scale, SCREEN_YSIZE * scale);
-
-            // keep aspect
-            float aspectScale = std::fminf(Engine.windowYSize / screenysize, Engine.windowXSize / screenxsize);
-            if (integerScaling) {
-                aspectScale = std::floor(aspectScale);
-            }
-            float xoffset          = (Engine.windowXSize - (screenxsize * aspectScale)) / 2;
-            float yoffset          = (Engine.windowYSize - (screenysize * aspectScale)) / 2;
-            destScreenPos_scaled.x = std::round(xoffset);
-            destScreenPos_scaled.y = std::round(yoffset);
-            destScreenPos_scaled.w = std::round(screenxsize * aspectScale);
-            destScreenPos_scaled.h = std::round(screenysize * aspectScale);
+
+        bool enhancedScaling = Engine.gameMode != ENGINE_VIDEOWAIT && UpdateScalingTarget();
+        if (enhancedScaling) {
+            texTarget            = scalingTarget.texture;
+            destScreenPos_scaled = scalingTarget.dest;
             // fill the screen with the texture, making lerp work.
-            SDL_RenderSetLogicalSize(Engine.renderer, Engine.windowXSize, Engine.windowYSize);
+            SetScalingLogicalSize(Engine.windowXSize, Engine.windowYSize);
         }
-        else if (Engine.gameMode == ENGINE_VIDEOWAIT) {
+        else {
+            SetScalingLogicalSize(SCREEN_XSIZE, SCREEN_YSIZE);
+        }
+
+        if (Engine.gameMode == ENGINE_VIDEOWAIT) {
             float screenAR = float(SCREEN_XSIZE) / float(SCREEN_YSIZE);
             if (screenAR > videoAR) {                               // If the screen is wider than the video. (Pillarboxed)
                 uint videoW         = uint(SCREEN_YSIZE * videoAR); // This is to force Pillarboxed mode if the screen is wider than the video.
@@ -522,7 +634,7 @@ void FlipScreen()
             SDL_RenderCopy(Engine.renderer, Engine.videoBuffer, NULL, destScreenPos);
         }
 
-        if ((Engine.scalingMode != 0 && !disableEnhancedScaling) && Engine.gameMode != ENGINE_VIDEOWAIT) {
+        if (enhancedScaling) {
             // set render target back to the screen.
             SDL_SetRenderTarget(Engine.renderer, NULL);
             // clear the screen itself now, for same reason as above
@@ -535,11 +647,6 @@ void FlipScreen()
                 SDL_RenderFillRect(Engine.renderer, NULL);
             // finally present it
             SDL_RenderPresent(Engine.renderer);
-            // reset everything just in case
-            SDL_RenderSetLogicalSize(Engine.renderer, SCREEN_XSIZE, SCREEN_YSIZE);
-            SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
-            // putting some FLEX TAPE� on that memory leak
-            SDL_DestroyTexture(texTarget);
         }
         else {
             // Apply dimming
@@ -890,6 +997,9 @@ void ReleaseRenderDevice()
 
     if (renderType == RENDER_SW) {
 #if RETRO_USING_SDL2 && !RETRO_USING_OPENGL
+#if !RETRO_USE_ORIGINAL_CODE
+        ReleaseScalingTarget();
+#endif
         SDL_DestroyTexture(Engine.screenBuffer);
         Engine.screenBuffer = NULL;
 #endif
@@ -1005,6 +1115,7 @@ void SetFullScreen(bool fs)
 
 void GenerateBlendLookupTable()
 {
+#if !RETRO_USE_CONSTEXPR_TABLES
     for (int y = 0; y < 0x100; y++) {
         for (int x = 0; x < 0x20; x++) {
             blendLookupTable[x + (0x20 * y)]    = y * x >> 8;
@@ -1016,6 +1127,7 @@ void GenerateBlendLookupTable()
         int tintValue      = ((i & 0x1F) + ((i & 0x7E0) >> 6) + ((i & 0xF800) >> 11)) / 3 + 6;
         tintLookupTable[i] = 0x841 * minVal(tintValue, 0x1F);
     }
+#endif
 }
 
 void ClearScreen(byte index)
@@ -1651,7 +1763,11 @@ void DrawObjectList(int Layer)
         int type   = objectEntityList[objectLoop].type;
 
         if (disableTouchControls && activeStageList == STAGELIST_SPECIAL) {
+#if !RETRO_USE_ORIGINAL_CODE
+            if (SymbolMatch(typeSymbols[type], SYMBOL_TOUCHCONTROLS))
+#else
             if (StrComp(typeNames[type], "TouchControls"))
+#endif
                 type = OBJ_TYPE_BLANKOBJECT;
         }
 
@@ -1867,6 +1983,32 @@ void DrawDebugOverlays()
             }
         }
     }
+
+    if (Engine.showInputLatency) {
+        // one bar per recent press, 2px per ms, with a marker line every frame period
+        // clamped so refresh rates above 1000hz don't make the marker loop below spin forever
+        int frameMS = Engine.refreshRate > 0 ? 1000 / Engine.refreshRate : 0;
+        if (frameMS < 1)
+            frameMS = 1;
+        int x       = 4;
+        int y       = SCREEN_YSIZE - 4;
+        DrawRectangle(x - 2, y - 66, 2 * INPUT_LATENCY_HISTORY + 4, 68, 0x00, 0x00, 0x00, 0x80);
+        for (int f = 1; f * frameMS < 32; ++f) DrawRectangle(x - 2, y - (f * frameMS << 1), 2 * INPUT_LATENCY_HISTORY + 4, 1, 0xFF, 0xFF, 0xFF, 0x60);
+
+        for (int i = 0; i < INPUT_LATENCY_HISTORY; ++i) {
+            float ms = inputLatencyMS[(inputLatencyPos + i) % INPUT_LATENCY_HISTORY];
+            int h    = ms > 32.0f ? 64 : (int)(ms * 2);
+            if (h <= 0)
+                continue;
+
+            if (ms <= frameMS)
+                DrawRectangle(x + (i << 1), y - h, 2, h, 0x00, 0xFF, 0x00, 0xC0);
+            else if (ms <= 2 * frameMS)
+                DrawRectangle(x + (i << 1), y - h, 2, h, 0xFF, 0xFF, 0x00, 0xC0);
+            else
+                DrawRectangle(x + (i << 1), y - h, 2, h, 0xFF, 0x00, 0x00, 0xC0);
+        }
+    }
 }
 #endif
 
@@ -1946,8 +2088,8 @@ void DrawHLineScrollLayer(int layerID)
                         deform = *deformationData;
 
                     // Fix for SS5 mobile bug
-                    if (StrComp(stageList[activeStageList][stageListPosition].name, "5") && activeStageList == STAGELIST_SPECIAL
-                        && renderType == RENDER_HW)
+                    if (activeStageList == STAGELIST_SPECIAL && renderType == RENDER_HW
+                        && StrComp(stageList[activeStageList][stageListPosition].name, "5"))
                         deform >>= 4;
 
                     chunkX += deform;
@@ -4443,8 +4585,8 @@ void DrawRectangle(int XPos, int YPos, int width, int height, int R, int G, int
             }
         }
         else {
-            ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - A)];
-            ushort *pixelBlend   = &blendLookupTable[0x20 * A];
+            const ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - A)];
+            const ushort *pixelBlend   = &blendLookupTable[0x20 * A];
 
             int h = height;
             while (h--) {
@@ -4649,7 +4791,11 @@ void DrawScaledTintMask(int direction, int XPos, int YPos, int pivotX, int pivot
 void DrawSprite(int XPos, int YPos, int width, int height, int sprX, int sprY, int sheetID)
 {
     if (disableTouchControls) {
+#if !RETRO_USE_ORIGINAL_CODE
+        if (SymbolMatch(gfxSurface[sheetID].fileSymbol, SYMBOL_DPAD_SHEET))
+#else
         if (StrComp(gfxSurface[sheetID].fileName, "Data/Sprites/Global/DPad.gif"))
+#endif
             return;
     }
 
@@ -5868,7 +6014,11 @@ void DrawBlendedSprite(int XPos, int YPos, int width, int height, int sprX, int
 void DrawAlphaBlendedSprite(int XPos, int YPos, int width, int height, int sprX, int sprY, int alpha, int sheetID)
 {
     if (disableTouchControls) {
+#if !RETRO_USE_ORIGINAL_CODE
+        if (SymbolMatch(gfxSurface[sheetID].fileSymbol, SYMBOL_DPAD_SHEET))
+#else
         if (StrComp(gfxSurface[sheetID].fileName, "Data/Sprites/Global/DPad.gif"))
+#endif
             return;
     }
 
@@ -5915,8 +6065,8 @@ void DrawAlphaBlendedSprite(int XPos, int YPos, int width, int height, int sprX,
             }
         }
         else {
-            ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - alpha)];
-            ushort *pixelBlend   = &blendLookupTable[0x20 * alpha];
+            const ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - alpha)];
+            const ushort *pixelBlend   = &blendLookupTable[0x20 * alpha];
 
             while (height--) {
                 activePalette   = fullPalette[*lineBuffer];
@@ -6012,13 +6162,13 @@ void DrawAdditiveBlendedSprite(int XPos, int YPos, int width, int height, int sp
         if (alpha > 0xFF)
             alpha = 0xFF;
 
-        ushort *blendTablePtr  = &blendLookupTable[0x20 * alpha];
-        GFXSurface *surface    = &gfxSurface[sheetID];
-        int pitch              = GFX_LINESIZE - width;
-        int gfxPitch           = surface->width - width;
-        byte *lineBuffer       = &gfxLineBuffer[YPos];
-        byte *gfxData          = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
-        ushort *frameBufferPtr = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
+        const ushort *blendTablePtr = &blendLookupTable[0x20 * alpha];
+        GFXSurface *surface         = &gfxSurface[sheetID];
+        int pitch                   = GFX_LINESIZE - width;
+        int gfxPitch                = surface->width - width;
+        byte *lineBuffer            = &gfxLineBuffer[YPos];
+        byte *gfxData               = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
+        ushort *frameBufferPtr      = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
 
         while (height--) {
             activePalette   = fullPalette[*lineBuffer];
@@ -6113,13 +6263,13 @@ void DrawSubtractiveBlendedSprite(int XPos, int YPos, int width, int height, int
         if (alpha > 0xFF)
             alpha = 0xFF;
 
-        ushort *subBlendTable  = &subtractLookupTable[0x20 * alpha];
-        GFXSurface *surface    = &gfxSurface[sheetID];
-        int pitch              = GFX_LINESIZE - width;
-        int gfxPitch           = surface->width - width;
-        byte *lineBuffer       = &gfxLineBuffer[YPos];
-        byte *gfxData          = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
-        ushort *frameBufferPtr = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
+        const ushort *subBlendTable = &subtractLookupTable[0x20 * alpha];
+        GFXSurface *surface         = &gfxSurface[sheetID];
+        int pitch                   = GFX_LINESIZE - width;
+        int gfxPitch                = surface->width - width;
+        byte *lineBuffer            = &gfxLineBuffer[YPos];
+        byte *gfxData               = &graphicData[sprX + surface->width * sprY + surface->dataPosition];
+        ushort *frameBufferPtr      = &Engine.frameBuffer[XPos + GFX_LINESIZE * YPos];
 
         while (height--) {
             activePalette   = fullPalette[*lineBuffer];
@@ -6297,6 +6447,37 @@ void DrawObjectAnimation(void *objScr, void *ent, int XPos, int YPos)
     }
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+// Flat span fill, two pixels per store once the destination is word aligned
+static inline void FillSpan16(ushort *dst, ushort colour, int count)
+{
+    if (count > 0 && ((size_t)dst & 2)) {
+        *dst++ = colour;
+        --count;
+    }
+
+    uint pair = colour | ((uint)colour << 16);
+    for (; count >= 2; count -= 2, dst += 2) memcpy(dst, &pair, sizeof(uint));
+
+    if (count > 0)
+        *dst = colour;
+}
+
+// Alpha span fill, the source colour's share of the blend is the same for every pixel so it's only looked up once
+static inline void BlendSpan16(ushort *dst, ushort colour, const ushort *fbufferBlend, const ushort *pixelBlend, int count)
+{
+    int srcR = pixelBlend[(colour & 0xF800) >> 11];
+    int srcG = pixelBlend[(colour & 0x7E0) >> 6];
+    int srcB = pixelBlend[colour & 0x1F];
+
+    while (count--) {
+        ushort pixel = *dst;
+        *dst++       = ((fbufferBlend[(pixel & 0xF800) >> 11] + srcR) << 11) | ((fbufferBlend[(pixel & 0x7E0) >> 6] + srcG) << 6)
+                 | (fbufferBlend[pixel & 0x1F] + srcB);
+    }
+}
+#endif
+
 void DrawFace(void *v, uint colour)
 {
     Vertex *verts = (Vertex *)v;
@@ -6360,6 +6541,9 @@ void DrawFace(void *v, uint colour)
             faceTop = 0;
         if (faceBottom > SCREEN_YSIZE)
             faceBottom = SCREEN_YSIZE;
+#if !RETRO_USE_ORIGINAL_CODE
+        ProcessFaceEdges(verts, vertexA, vertexB, vertexC, vertexD);
+#else
         for (int i = faceTop; i < faceBottom; ++i) {
             faceLineStart[i] = 100000;
             faceLineEnd[i]   = -100000;
@@ -6371,6 +6555,7 @@ void DrawFace(void *v, uint colour)
         ProcessScanEdge(&verts[vertexB], &verts[vertexC]);
         ProcessScanEdge(&verts[vertexC], &verts[vertexD]);
         ProcessScanEdge(&verts[vertexB], &verts[vertexD]);
+#endif
 
         ushort colour16 = 0;
         PACK_RGB888(colour16, ((colour >> 16) & 0xFF), ((colour >> 8) & 0xFF), ((colour >> 0) & 0xFF));
@@ -6391,17 +6576,21 @@ void DrawFace(void *v, uint colour)
                     ushort *fbPtr = &frameBufferPtr[startX];
                     frameBufferPtr += GFX_LINESIZE;
                     int vertexwidth = endX - startX + 1;
+#if !RETRO_USE_ORIGINAL_CODE
+                    FillSpan16(fbPtr, colour16, vertexwidth);
+#else
                     while (vertexwidth--) {
                         *fbPtr = colour16;
                         ++fbPtr;
                     }
+#endif
                 }
                 ++faceTop;
             }
         }
         else {
-            ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - alpha)];
-            ushort *pixelBlend   = &blendLookupTable[0x20 * alpha];
+            const ushort *fbufferBlend = &blendLookupTable[0x20 * (0xFF - alpha)];
+            const ushort *pixelBlend   = &blendLookupTable[0x20 * alpha];
 
             while (faceTop < faceBottom) {
                 int startX = faceLineStart[faceTop];
@@ -6417,6 +6606,9 @@ void DrawFace(void *v, uint colour)
                     ushort *fbPtr = &frameBufferPtr[startX];
                     frameBufferPtr += GFX_LINESIZE;
                     int vertexwidth = endX - startX + 1;
+#if !RETRO_USE_ORIGINAL_CODE
+                    BlendSpan16(fbPtr, colour16, fbufferBlend, pixelBlend, vertexwidth);
+#else
                     while (vertexwidth--) {
                         int R = (fbufferBlend[(*fbPtr & 0xF800) >> 11] + pixelBlend[(colour16 & 0xF800) >> 11]) << 11;
                         int G = (fbufferBlend[(*fbPtr & 0x7E0) >> 6] + pixelBlend[(colour16 & 0x7E0) >> 6]) << 6;
@@ -6425,6 +6617,7 @@ void DrawFace(void *v, uint colour)
                         *fbPtr = R | G | B;
                         ++fbPtr;
                     }
+#endif
                 }
                 ++faceTop;
             }
@@ -6541,6 +6734,9 @@ void DrawTexturedFace(void *v, byte sheetID)
             faceTop = 0;
         if (faceBottom > SCREEN_YSIZE)
             faceBottom = SCREEN_YSIZE;
+#if !RETRO_USE_ORIGINAL_CODE
+        ProcessFaceEdgesUV(verts, vertexA, vertexB, vertexC, vertexD);
+#else
         for (int i = faceTop; i < faceBottom; ++i) {
             faceLineStart[i] = 100000;
             faceLineEnd[i]   = -100000;
@@ -6552,6 +6748,7 @@ void DrawTexturedFace(void *v, byte sheetID)
         ProcessScanEdgeUV(&verts[vertexB], &verts[vertexC]);
         ProcessScanEdgeUV(&verts[vertexC], &verts[vertexD]);
         ProcessScanEdgeUV(&verts[vertexB], &verts[vertexD]);
+#endif
 
         ushort *frameBufferPtr = &Engine.frameBuffer[GFX_LINESIZE * faceTop];
         byte *sheetPtr         = &graphicData[gfxSurface[sheetID].dataPosition];
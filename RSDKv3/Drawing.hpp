@@ -26,11 +26,20 @@ struct GFXSurface {
     int texStartX;
     int texStartY;
     int dataPosition;
+#if !RETRO_USE_ORIGINAL_CODE
+    int fileSymbol;
+#endif
 };
 
+#if RETRO_USE_CONSTEXPR_TABLES
+extern const std::array<ushort, 0x100 * 0x20> blendLookupTable;
+extern const std::array<ushort, 0x100 * 0x20> subtractLookupTable;
+extern const std::array<ushort, 0x10000> tintLookupTable;
+#else
 extern ushort blendLookupTable[0x100 * 0x20];
 extern ushort subtractLookupTable[0x100 * 0x20];
 extern ushort tintLookupTable[0x10000];
+#endif
 
 extern int SCREEN_XSIZE;
 extern int SCREEN_CENTERX;
@@ -28,6 +28,7 @@ public:
         char key[0x40];
         char value[0x100];
         byte type = INI_ITEM_STRING;
+        uint hash = 0;
     };
 
     IniParser() { items.clear(); }
@@ -44,6 +45,20 @@ public:
     int SetComment(const char *section, const char *key, const char *comment);
     void Write(const char *filename, bool addPath = true);
 
+    int FindItem(const char *section, const char *key);
+    int AddItem(const char *section, const char *key);
+
     std::vector<ConfigItem> items;
+    // open addressing over items by section + key, -1 marks an empty slot. Items without a key (comments read from the file) aren't indexed
+    std::vector<int> itemTable;
+
+private:
+    void IndexItem(int id);
+    void InsertItem(int id);
 };
+
+#if !RETRO_USE_ORIGINAL_CODE
+// Tool mode: parses a generated ini with keyCount keys and logs parse and lookup times
+int BenchmarkIniParser(int keyCount);
+#endif
 #endif // !INI_H
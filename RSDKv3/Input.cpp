@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <vector>
+#include <time.h>
 
 #if RETRO_PLATFORM == RETRO_3DS
 extern "C" {
@@ -167,9 +168,42 @@ float LTRIGGER_DEADZONE = 0.3;
 float RTRIGGER_DEADZONE = 0.3;
 
 int mouseHideTimer = 0;
+
+unsigned long long inputSampleTicks  = 0;
+unsigned long long inputPendingTicks = 0; // earliest press sampled since the last present
+
+float inputLatencyMS[INPUT_LATENCY_HISTORY];
+int inputLatencyPos = 0;
 int lastMouseX     = 0;
 int lastMouseY     = 0;
 
+int replayMode         = REPLAY_NONE;
+char replayPath[0x100] = "";
+int replayHashInterval = 0;
+uint replaySeed        = 0;
+
+#define REPLAY_SIGNATURE   (0x4C505252) // "RRPL"
+#define REPLAY_VERSION     (1)
+#define REPLAY_HEADER_SIZE (0x14)
+
+enum ReplayRecordTypes {
+    REPLAYREC_INPUT, // mask, run length
+    REPLAYREC_HASH,  // 32-bit game state hash at the end of the tick
+};
+
+FileIO *replayFile       = NULL;
+byte *replayData         = NULL;
+int replayDataSize       = 0;
+int replayDataPos        = 0;
+uint replayTick          = 0;
+byte replayRunMask       = 0;
+int replayRunLength      = 0;
+bool replayFinished      = false;
+int replayHashChecks     = 0;
+int replayHashMismatches = 0;
+int replayFirstDesync    = -1;
+unsigned long long replayStartTicks = 0;
+
 #if RETRO_USING_SDL2
 std::vector<SDL_GameController *> controllers;
 #endif
@@ -361,8 +395,18 @@ void ControllerClose(byte controllerID)
 }
 #endif //! RETRO_USING_SDL2
 
+static void ReadReplayInput();
+static void WriteReplayInput();
+
 void ProcessInput()
 {
+    inputSampleTicks = Time_GetPerformanceCounter();
+
+    if (replayMode == REPLAY_PLAY) {
+        ReadReplayInput();
+        return;
+    }
+
 #if RETRO_PLATFORM == RETRO_3DS
     hidScanInput();
     u32 kHeld = hidKeysHeld();
@@ -573,6 +617,265 @@ void ProcessInput()
         inputDevice[INPUT_ANY].setReleased();
     }
 #endif //! RETRO_USING_SDL2
+
+    if (!inputPendingTicks) {
+        for (int i = 0; i < INPUT_ANY; ++i) {
+            if (inputDevice[i].press) {
+                inputPendingTicks = inputDevice[i].changeTicks;
+                break;
+            }
+        }
+    }
+
+    if (replayMode == REPLAY_RECORD)
+        WriteReplayInput();
+}
+
+// Measures from the sample that saw a press to the present of the frame that used it,
+// which excludes scanout and the time between the physical press and the sample
+void UpdateInputLatency(unsigned long long presentTicks)
+{
+    if (!inputPendingTicks)
+        return;
+
+    inputLatencyMS[inputLatencyPos] = (presentTicks - inputPendingTicks) * 1000.0f / Time_GetPerformanceFrequency();
+    inputLatencyPos                 = (inputLatencyPos + 1) % INPUT_LATENCY_HISTORY;
+    inputPendingTicks               = 0;
+}
+
+#if RETRO_PLATFORM == RETRO_3DS
+// True on the tick the last of the buttons in keys goes down while the rest are held
+bool CheckDevHotkey(int keys)
+{
+    return keys && (hidKeysHeld() & keys) == (u32)keys && (hidKeysDown() & keys);
+}
+#elif RETRO_PLATFORM == RETRO_3DSSIM
+bool CheckDevHotkey(int keys)
+{
+    static bool prevHeld[0x100];
+    if (keys <= 0 || keys >= 0x100)
+        return false;
+
+    bool held       = (GetAsyncKeyState(keys) & 0x8000) != 0;
+    bool pressed    = held && !prevHeld[keys];
+    prevHeld[keys]  = held;
+    return pressed;
+}
+#endif
+
+static void WriteReplayU32(byte *dst, uint value)
+{
+    dst[0] = value & 0xFF;
+    dst[1] = (value >> 8) & 0xFF;
+    dst[2] = (value >> 16) & 0xFF;
+    dst[3] = (value >> 24) & 0xFF;
+}
+
+static uint ReadReplayU32(const byte *src) { return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint)src[3] << 24); }
+
+static void WriteReplayHeader()
+{
+    byte header[REPLAY_HEADER_SIZE];
+    WriteReplayU32(&header[0x00], REPLAY_SIGNATURE);
+    header[0x04] = REPLAY_VERSION & 0xFF;
+    header[0x05] = REPLAY_VERSION >> 8;
+    header[0x06] = replayHashInterval & 0xFF;
+    header[0x07] = (replayHashInterval >> 8) & 0xFF;
+    WriteReplayU32(&header[0x08], replaySeed);
+    header[0x0C] = Engine.startList_Game;
+    header[0x0D] = Engine.startStage_Game;
+    header[0x0E] = 0;
+    header[0x0F] = 0;
+    WriteReplayU32(&header[0x10], replayTick);
+
+    fSeek(replayFile, 0, SEEK_SET);
+    fWrite(header, 1, REPLAY_HEADER_SIZE, replayFile);
+    fSeek(replayFile, 0, SEEK_END);
+}
+
+static void FlushReplayRun()
+{
+    if (!replayRunLength)
+        return;
+
+    byte record[3];
+    record[0] = REPLAYREC_INPUT;
+    record[1] = replayRunMask;
+    record[2] = replayRunLength;
+    fWrite(record, 1, sizeof(record), replayFile);
+    replayRunLength = 0;
+}
+
+static void WriteReplayInput()
+{
+    byte mask = 0;
+    for (int i = 0; i < INPUT_ANY; ++i) {
+        if (inputDevice[i].hold)
+            mask |= 1 << i;
+    }
+
+    if (replayRunLength && (mask != replayRunMask || replayRunLength == 0xFF))
+        FlushReplayRun();
+    replayRunMask = mask;
+    ++replayRunLength;
+}
+
+static void FinishReplay()
+{
+    replayFinished = true;
+    Engine.running = false;
+
+    double time = (double)(Time_GetPerformanceCounter() - replayStartTicks) * 1000.0 / (double)Time_GetPerformanceFrequency();
+    PrintLog("Replay finished: %u ticks in %.3fms (%.4fms per tick)", replayTick, time, replayTick ? time / replayTick : 0.0);
+    if (replayHashChecks) {
+        if (replayHashMismatches)
+            PrintLog("Replay desynced: %d of %d state hashes differed, first at tick %d", replayHashMismatches, replayHashChecks,
+                     replayFirstDesync);
+        else
+            PrintLog("Replay matched all %d state hashes", replayHashChecks);
+    }
+}
+
+static void ReadReplayInput()
+{
+    if (replayFinished)
+        return;
+
+    if (!replayRunLength) {
+        if (replayDataPos + 3 > replayDataSize || replayData[replayDataPos] != REPLAYREC_INPUT) {
+            for (int i = 0; i < INPUT_BUTTONCOUNT; ++i) inputDevice[i].setReleased();
+            FinishReplay();
+            return;
+        }
+        replayRunMask   = replayData[replayDataPos + 1];
+        replayRunLength = replayData[replayDataPos + 2];
+        replayDataPos += 3;
+    }
+    --replayRunLength;
+
+    // same rules as sampling a real device, so press/hold edges come out identical
+    for (int i = 0; i < INPUT_ANY; ++i) {
+        if (replayRunMask & (1 << i)) {
+            inputDevice[i].setHeld();
+            if (!inputDevice[INPUT_ANY].hold)
+                inputDevice[INPUT_ANY].setHeld();
+        }
+        else if (inputDevice[i].hold)
+            inputDevice[i].setReleased();
+    }
+    if (!replayRunMask)
+        inputDevice[INPUT_ANY].setReleased();
+}
+
+bool InitReplay()
+{
+    if (replayMode == REPLAY_RECORD) {
+        replayFile = fOpen(replayPath, "wb");
+        if (!replayFile) {
+            PrintLog("Unable to open replay file for recording: %s", replayPath);
+            replayMode = REPLAY_NONE;
+            return false;
+        }
+
+        replaySeed = (uint)time(NULL);
+        replayTick = 0;
+        WriteReplayHeader(); // tick count is patched in ReleaseReplay
+        PrintLog("Recording replay to: %s (seed %u)", replayPath, replaySeed);
+        return true;
+    }
+
+    if (replayMode == REPLAY_PLAY) {
+        FileIO *file = fOpen(replayPath, "rb");
+        if (!file) {
+            PrintLog("Unable to open replay file: %s", replayPath);
+            replayMode = REPLAY_NONE;
+            return false;
+        }
+
+        fSeek(file, 0, SEEK_END);
+        replayDataSize = (int)fTell(file);
+        fSeek(file, 0, SEEK_SET);
+        if (replayDataSize >= REPLAY_HEADER_SIZE)
+            replayData = (byte *)malloc(replayDataSize);
+        if (replayData)
+            fRead(replayData, 1, replayDataSize, file);
+        fClose(file);
+
+        if (!replayData || ReadReplayU32(replayData) != REPLAY_SIGNATURE || (replayData[4] | (replayData[5] << 8)) != REPLAY_VERSION) {
+            PrintLog("Invalid replay file: %s", replayPath);
+            if (replayData)
+                free(replayData);
+            replayData = NULL;
+            replayMode = REPLAY_NONE;
+            return false;
+        }
+
+        replayHashInterval     = replayData[6] | (replayData[7] << 8);
+        replaySeed             = ReadReplayU32(&replayData[0x08]);
+        Engine.startList_Game  = replayData[0x0C];
+        Engine.startStage_Game = replayData[0x0D];
+        replayDataPos          = REPLAY_HEADER_SIZE;
+        replayTick             = 0;
+        replayRunLength        = 0;
+        PrintLog("Playing replay: %s (%u ticks, seed %u)", replayPath, ReadReplayU32(&replayData[0x10]), replaySeed);
+        replayStartTicks = Time_GetPerformanceCounter();
+        return true;
+    }
+
+    return false;
+}
+
+// Called once the logic for a tick has run
+void ProcessReplayTick()
+{
+    if (replayFinished)
+        return;
+
+    ++replayTick;
+    if (replayHashInterval <= 0 || replayTick % replayHashInterval)
+        return;
+
+    uint hash = GetGameStateHash();
+    if (replayMode == REPLAY_RECORD) {
+        // the run is split here so the hash lands in the stream right after this tick's input
+        FlushReplayRun();
+        byte record[5];
+        record[0] = REPLAYREC_HASH;
+        WriteReplayU32(&record[1], hash);
+        fWrite(record, 1, sizeof(record), replayFile);
+    }
+    else if (replayMode == REPLAY_PLAY && !replayRunLength) {
+        if (replayDataPos + 5 <= replayDataSize && replayData[replayDataPos] == REPLAYREC_HASH) {
+            uint recorded = ReadReplayU32(&replayData[replayDataPos + 1]);
+            replayDataPos += 5;
+            ++replayHashChecks;
+            if (recorded != hash) {
+                if (!replayHashMismatches++) {
+                    replayFirstDesync = replayTick;
+                    PrintLog("Replay desync at tick %u: state hash %08X, recorded %08X", replayTick, hash, recorded);
+                }
+            }
+        }
+    }
+}
+
+void ReleaseReplay()
+{
+    if (replayFile) {
+        FlushReplayRun();
+        WriteReplayHeader();
+        fClose(replayFile);
+        replayFile = NULL;
+        PrintLog("Recorded replay: %u ticks", replayTick);
+    }
+    else if (replayMode == REPLAY_PLAY && !replayFinished) {
+        FinishReplay();
+    }
+
+    if (replayData)
+        free(replayData);
+    replayData = NULL;
+    replayMode = REPLAY_NONE;
 }
 #endif //! !RETRO_USE_ORIGINAL_CODE
 
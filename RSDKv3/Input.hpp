@@ -25,17 +25,34 @@ struct InputData {
     bool start;
 };
 
+#if !RETRO_USE_ORIGINAL_CODE
+#define INPUT_LATENCY_HISTORY (0x40)
+
+extern unsigned long long inputSampleTicks; // performance counter at the last ProcessInput
+#endif
+
 struct InputButton {
     bool press, hold;
     int keyMappings, contMappings;
+#if !RETRO_USE_ORIGINAL_CODE
+    unsigned long long changeTicks; // sample time of the last press or release
+#endif
 
     inline void setHeld()
     {
+#if !RETRO_USE_ORIGINAL_CODE
+        if (!hold)
+            changeTicks = inputSampleTicks;
+#endif
         press = !hold;
         hold  = true;
     }
     inline void setReleased()
     {
+#if !RETRO_USE_ORIGINAL_CODE
+        if (hold)
+            changeTicks = inputSampleTicks;
+#endif
         press = false;
         hold  = false;
     }
@@ -71,6 +88,31 @@ extern float LTRIGGER_DEADZONE;
 extern float RTRIGGER_DEADZONE;
 
 extern int mouseHideTimer;
+
+extern float inputLatencyMS[INPUT_LATENCY_HISTORY];
+extern int inputLatencyPos;
+
+void UpdateInputLatency(unsigned long long presentTicks);
+
+enum ReplayModes {
+    REPLAY_NONE,
+    REPLAY_RECORD,
+    REPLAY_PLAY,
+};
+
+// Input replay: records the buttons sampled each tick (plus the rand seed and starting stage) so a run can be played back headless
+extern int replayMode;
+extern char replayPath[0x100];
+extern int replayHashInterval; // ticks between game state hashes, 0 to disable
+extern uint replaySeed;
+
+#if RETRO_PLATFORM == RETRO_3DS || RETRO_PLATFORM == RETRO_3DSSIM
+bool CheckDevHotkey(int keys);
+#endif
+
+bool InitReplay();
+void ProcessReplayTick();
+void ReleaseReplay();
 #endif
 
 #if !RETRO_USE_ORIGINAL_CODE
@@ -6,6 +6,175 @@
 #define M_PI 3.14159265358979323846264338327950288
 #endif
 
+#if RETRO_USE_CONSTEXPR_TABLES
+// libm isn't usable in constant expressions, so these stand in for sin, cos & atan2f
+// they're accurate to within an ulp or two, which is enough for every table entry to match the libm generated ones
+constexpr double ConstSinSeries(double x)
+{
+    double x2   = x * x;
+    double term = x;
+    double sum  = x;
+    for (int n = 1; n < 16; ++n) {
+        term *= -x2 / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double ConstCosSeries(double x)
+{
+    double x2   = x * x;
+    double term = 1.0;
+    double sum  = 1.0;
+    for (int n = 1; n < 16; ++n) {
+        term *= -x2 / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double ConstAtanSeries(double x, int terms)
+{
+    double x2  = x * x;
+    double pow = x;
+    double sum = 0.0;
+    for (int n = 0; n < terms; ++n) {
+        sum += pow / (2 * n + 1);
+        pow *= -x2;
+    }
+    return sum;
+}
+
+// x must be in the range [0, 2PI)
+constexpr double ConstSin(double x)
+{
+    double sign = 1.0;
+    if (x > M_PI) {
+        x -= M_PI;
+        sign = -1.0;
+    }
+    if (x > M_PI / 2)
+        x = M_PI - x;
+    return sign * ConstSinSeries(x);
+}
+
+// x must be in the range [0, 2PI)
+constexpr double ConstCos(double x)
+{
+    if (x > M_PI)
+        x = 2 * M_PI - x;
+    if (x > M_PI / 2)
+        return -ConstCosSeries(M_PI - x);
+    return ConstCosSeries(x);
+}
+
+constexpr std::array<int, 0x200> GenerateSinMTable(bool cosine)
+{
+    std::array<int, 0x200> table = {};
+    for (int i = 0; i < 0x200; ++i) {
+        if (cosine)
+            table[i] = (ConstCos((i / 256.0) * M_PI) * 4096.0);
+        else
+            table[i] = (ConstSin((i / 256.0) * M_PI) * 4096.0);
+    }
+
+    if (cosine) {
+        table[0x00]  = 0x1000;
+        table[0x80]  = 0;
+        table[0x100] = -0x1000;
+        table[0x180] = 0;
+    }
+    else {
+        table[0x00]  = 0;
+        table[0x80]  = 0x1000;
+        table[0x100] = 0;
+        table[0x180] = -0x1000;
+    }
+    return table;
+}
+
+constexpr std::array<int, 0x200> GenerateSin512Table(bool cosine)
+{
+    std::array<int, 0x200> table = {};
+    for (int i = 0; i < 0x200; ++i) {
+        // sinf/cosf take a float, so the angle is rounded to float & the result is rounded back to float
+        float angle = (i / 256.0) * M_PI;
+        if (cosine)
+            table[i] = ((float)ConstCos(angle) * 512.0);
+        else
+            table[i] = ((float)ConstSin(angle) * 512.0);
+    }
+
+    if (cosine) {
+        table[0x00]  = 0x200;
+        table[0x80]  = 0;
+        table[0x100] = -0x200;
+        table[0x180] = 0;
+    }
+    else {
+        table[0x00]  = 0;
+        table[0x80]  = 0x200;
+        table[0x100] = 0;
+        table[0x180] = -0x200;
+    }
+    return table;
+}
+
+constexpr std::array<int, 0x100> GenerateSin256Table(bool cosine)
+{
+    std::array<int, 0x200> table512 = GenerateSin512Table(cosine);
+    std::array<int, 0x100> table    = {};
+    for (int i = 0; i < 0x100; i++) table[i] = (table512[i * 2] >> 1);
+    return table;
+}
+
+constexpr std::array<byte, 0x100 * 0x100> GenerateArcTanTable()
+{
+    // atan(Y/X) is split into atan(c) + atan((t - c) / (1 + tc)) for the nearest c = k/8, so the series converges in a few terms
+    double atanBase[9] = {};
+    for (int k = 1; k <= 8; ++k) {
+        double c = k / 8.0;
+        if (k > 3)
+            atanBase[k] = M_PI / 4 + ConstAtanSeries((c - 1.0) / (c + 1.0), 40);
+        else
+            atanBase[k] = ConstAtanSeries(c, 40);
+    }
+
+    std::array<byte, 0x100 * 0x100> table = {};
+    for (int Y = 0; Y < 0x100; ++Y) {
+        for (int X = 0; X < 0x100; ++X) {
+            float angle = 0.0f;
+            if (!X) {
+                angle = Y ? (float)(M_PI / 2) : 0.0f;
+            }
+            else {
+                double t    = (double)Y / (double)X;
+                bool invert = t > 1.0;
+                if (invert)
+                    t = 1.0 / t;
+
+                int k       = (int)(t * 8.0 + 0.5);
+                double c    = k / 8.0;
+                double atan = atanBase[k] + ConstAtanSeries((t - c) / (1.0 + t * c), 10);
+                angle       = (float)(invert ? M_PI / 2 - atan : atan);
+            }
+            table[X * 0x100 + Y] = (angle * 40.743664f);
+        }
+    }
+    return table;
+}
+
+constexpr std::array<int, 0x200> sinMLookupTable = GenerateSinMTable(false);
+constexpr std::array<int, 0x200> cosMLookupTable = GenerateSinMTable(true);
+
+constexpr std::array<int, 0x200> sin512LookupTable = GenerateSin512Table(false);
+constexpr std::array<int, 0x200> cos512LookupTable = GenerateSin512Table(true);
+
+constexpr std::array<int, 0x100> sin256LookupTable = GenerateSin256Table(false);
+constexpr std::array<int, 0x100> cos256LookupTable = GenerateSin256Table(true);
+
+constexpr std::array<byte, 0x100 * 0x100> arcTan256LookupTable = GenerateArcTanTable();
+#else
 int sinMLookupTable[512];
 int cosMLookupTable[512];
 
@@ -16,11 +185,15 @@ int sin256LookupTable[256];
 int cos256LookupTable[256];
 
 byte arcTan256LookupTable[0x100 * 0x100];
+#endif
 
 void CalculateTrigAngles()
 {
+#if RETRO_USE_ORIGINAL_CODE
     srand((unsigned)time(NULL));
+#endif
 
+#if !RETRO_USE_CONSTEXPR_TABLES
     for (int i = 0; i < 0x200; ++i) {
         sinMLookupTable[i] = (sin((i / 256.0) * M_PI) * 4096.0);
         cosMLookupTable[i] = (cos((i / 256.0) * M_PI) * 4096.0);
@@ -64,6 +237,7 @@ void CalculateTrigAngles()
             atan += 0x100;
         }
     }
+#endif
 }
 
 byte ArcTanLookup(int X, int Y)
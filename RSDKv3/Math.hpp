@@ -10,6 +10,18 @@
 #define MEM_ZERO(x)  memset(&(x), 0, sizeof((x)))
 #define MEM_ZEROP(x) memset((x), 0, sizeof(*(x)))
 
+#if RETRO_USE_CONSTEXPR_TABLES
+extern const std::array<int, 0x200> sinMLookupTable;
+extern const std::array<int, 0x200> cosMLookupTable;
+
+extern const std::array<int, 0x200> sin512LookupTable;
+extern const std::array<int, 0x200> cos512LookupTable;
+
+extern const std::array<int, 0x100> sin256LookupTable;
+extern const std::array<int, 0x100> cos256LookupTable;
+
+extern const std::array<byte, 0x100 * 0x100> arcTan256LookupTable;
+#else
 extern int sinMLookupTable[0x200];
 extern int cosMLookupTable[0x200];
 
@@ -20,6 +32,7 @@ extern int sin256LookupTable[0x100];
 extern int cos256LookupTable[0x100];
 
 extern byte arcTan256LookupTable[0x100 * 0x100];
+#endif
 
 // Setup Angles
 void CalculateTrigAngles();
@@ -8,6 +8,9 @@ char savePath[0x100];
 std::vector<ModInfo> modList;
 int activeMod = -1;
 
+std::unordered_map<std::string, ModFile> modFileMap;
+bool modFileMapDirty = true;
+
 char modsPath[0x100];
 
 bool redirectSave           = false;
@@ -121,6 +124,9 @@ void InitMods()
             IniParser modConfig(mod_config.c_str(), false);
 
             for (int m = 0; m < modConfig.items.size(); ++m) {
+                if (modConfig.items[m].type == IniParser::INI_ITEM_COMMENT)
+                    continue;
+
                 bool active = false;
                 ModInfo info;
                 modConfig.GetBool("mods", modConfig.items[m].key, &active);
@@ -188,6 +194,9 @@ void InitMods()
             disableSaveIniOverride = true;
     }
 
+    modFileMapDirty = true;
+    RefreshModFileMap();
+
     ReadSaveRAMData();
     ReadUserdata();
 }
@@ -198,6 +207,7 @@ bool LoadMod(ModInfo *info, std::string modsPath, std::string folder, bool activ
         return false;
 
     info->fileMap.clear();
+    info->scanTimes.clear();
     info->name    = "";
     info->desc    = "";
     info->author  = "";
@@ -272,237 +282,357 @@ bool LoadMod(ModInfo *info, std::string modsPath, std::string folder, bool activ
     return false;
 }
 
-void ScanModFolder(ModInfo *info)
+time_t GetModifiedTime(const std::string &path)
 {
-    if (!info)
+    struct stat s;
+    if (stat(path.c_str(), &s) == 0)
+        return s.st_mtime;
+    return 0;
+}
+
+void ScanModSubFolder(ModInfo *info, const std::string &folderPath, const char *folderName)
+{
+    if (!pathExists(folderPath) || !isDirectory(folderPath))
         return;
 
-    char modBuf[0x100];
-    sprintf(modBuf, "%smods", modsPath);
+    char folderTest[4][0x10];
+    sprintf(folderTest[0], "%s/", folderName);
+    sprintf(folderTest[1], "%s\\", folderName);
+    StrCopy(folderTest[2], folderTest[0]);
+    StrCopy(folderTest[3], folderTest[1]);
+    folderTest[2][0] = tolower(folderTest[2][0]);
+    folderTest[3][0] = tolower(folderTest[3][0]);
 
-    std::string modPath = ResolvePath(modBuf);
+    std::stack<std::string> dirs;
 
-    const std::string modDir = modPath + "/" + info->folder;
+    // Push the initial directory to the stack
+    dirs.push(folderPath);
 
-    // Check for Data/ replacements
-    std::string dataPath = ResolvePath(modDir + "/Data");
+    while (!dirs.empty()) {
+        std::string currentDir = dirs.top();
 
-    if (pathExists(dataPath) && isDirectory(dataPath)) {
-        std::stack<std::string> dirs;
+        // Pop the top directory from the stack
+        dirs.pop();
 
-        // Push the initial directory to the stack
-        dirs.push(dataPath);
+        DIR *dir = opendir(currentDir.c_str());
+        if (!dir) {
+            continue;
+        }
+        info->scanTimes.push_back(std::pair<std::string, time_t>(currentDir, GetModifiedTime(currentDir)));
 
-        while (!dirs.empty()) {
-            std::string currentDir = dirs.top();
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            // Skip "." and ".."
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
 
-            // Pop the top directory from the stack
-            dirs.pop();
+            std::string fullPath = currentDir + "/" + entry->d_name;
 
-            DIR *dir = opendir(currentDir.c_str());
-            if (!dir) {
+            struct stat st;
+            if (stat(fullPath.c_str(), &st) != 0)
                 continue;
-            }
 
-            struct dirent *entry;
-            while ((entry = readdir(dir)) != NULL) {
-                // Skip "." and ".."
-                if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-                    continue;
+            if (S_ISREG(st.st_mode)) {
+                char modBuf[0x100];
+                StrCopy(modBuf, fullPath.c_str());
+                int tokenPos = -1;
+                for (int i = 0; i < 4; ++i) {
+                    tokenPos = FindStringToken(modBuf, folderTest[i], 1);
+                    if (tokenPos >= 0)
+                        break;
                 }
 
-                std::string fullPath = currentDir + "/" + entry->d_name;
-
-                if (isRegularFile(fullPath)) {
-                    char modBuf[0x100];
-                    StrCopy(modBuf, fullPath.c_str());
-                    char folderTest[4][0x10] = {
-                        "Data/",
-                        "Data\\",
-                        "data/",
-                        "data\\",
-                    };
-                    int tokenPos = -1;
-                    for (int i = 0; i < 4; ++i) {
-                        tokenPos = FindStringToken(modBuf, folderTest[i], 1);
-                        if (tokenPos >= 0)
-                            break;
+                if (tokenPos >= 0) {
+                    char pathLower[0x100];
+                    memset(pathLower, 0, sizeof(char) * 0x100);
+                    for (int i = StrLength(modBuf); i >= tokenPos; --i) {
+                        pathLower[i - tokenPos] = tolower(modBuf[i] == '\\' ? '/' : modBuf[i]);
                     }
 
-                    if (tokenPos >= 0) {
-                        char buffer[0x100];
-                        for (int i = StrLength(modBuf); i >= tokenPos; --i) {
-                            buffer[i - tokenPos] = modBuf[i] == '\\' ? '/' : modBuf[i];
-                        }
-
-                        // PrintLog(modBuf);
-                        std::string path(buffer);
-                        std::string modPath(modBuf);
-                        char pathLower[0x100];
-                        memset(pathLower, 0, sizeof(char) * 0x100);
-                        for (int c = 0; c < path.size(); ++c) {
-                            pathLower[c] = tolower(path.c_str()[c]);
-                        }
-
-                        info->fileMap.insert(std::pair<std::string, std::string>(pathLower, modBuf));
-                    }
-                }
-                else if (isDirectory(fullPath)) {
-                    dirs.push(fullPath);
+                    ModFile file;
+                    file.path   = modBuf;
+                    file.offset = -1;
+                    file.size   = (int)st.st_size;
+                    info->fileMap.insert(std::pair<std::string, ModFile>(pathLower, file));
                 }
             }
-
-            closedir(dir);
+            else if (S_ISDIR(st.st_mode)) {
+                dirs.push(fullPath);
+            }
         }
+
+        closedir(dir);
     }
+}
 
-    // Check for Scripts/ replacements
-    std::string scriptPath = ResolvePath(modDir + "/Scripts");
+void ScanModPack(ModInfo *info, const std::string &packPath)
+{
+    FileIO *file = fOpen(packPath.c_str(), "rb");
+    if (!file)
+        return;
 
-    if (pathExists(scriptPath) && isDirectory(scriptPath)) {
-        std::stack<std::string> dirs;
+    byte header[0x10];
+    if (fRead(header, 1, sizeof(header), file) != sizeof(header)) {
+        fClose(file);
+        return;
+    }
 
-        // Push the initial directory to the stack
-        dirs.push(dataPath);
+    uint signature = header[0] | (header[1] << 8) | (header[2] << 16) | (header[3] << 24);
+    ushort version = header[4] | (header[5] << 8);
+    uint fileCount = header[8] | (header[9] << 8) | (header[10] << 16) | (header[11] << 24);
+    uint tocSize   = header[12] | (header[13] << 8) | (header[14] << 16) | (header[15] << 24);
+    if (signature != MODPACK_SIGNATURE || version != MODPACK_VERSION) {
+        PrintLog("Invalid mod pack '%s'", packPath.c_str());
+        fClose(file);
+        return;
+    }
 
-        while (!dirs.empty()) {
-            std::string currentDir = dirs.top();
+    // the whole table of contents is read in one go, so mounting a pack costs a single open & read
+    byte *toc = (byte *)malloc(tocSize);
+    if (!toc || fRead(toc, 1, tocSize, file) != tocSize) {
+        PrintLog("Invalid mod pack '%s'", packPath.c_str());
+        if (toc)
+            free(toc);
+        fClose(file);
+        return;
+    }
+    fClose(file);
 
-            // Pop the top directory from the stack
-            dirs.pop();
+    info->packPath = packPath;
 
-            DIR *dir = opendir(currentDir.c_str());
-            if (!dir) {
-                continue;
-            }
+    uint pos = 0;
+    for (uint f = 0; f < fileCount; ++f) {
+        if (pos + 1 > tocSize || pos + 1 + toc[pos] + 9 > tocSize)
+            break;
 
-            struct dirent *entry;
-            while ((entry = readdir(dir)) != NULL) {
-                // Skip "." and ".."
-                if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-                    continue;
-                }
+        byte nameLength = toc[pos++];
+        char pathLower[0x100];
+        for (int c = 0; c < nameLength; ++c) {
+            char chr     = toc[pos++];
+            pathLower[c] = tolower(chr == '\\' ? '/' : chr);
+        }
+        pathLower[nameLength] = 0;
 
-                std::string fullPath = currentDir + "/" + entry->d_name;
-
-                if (isRegularFile(fullPath)) {
-                    char modBuf[0x100];
-                    StrCopy(modBuf, fullPath.c_str());
-                    char folderTest[4][0x10] = {
-                        "Scripts/",
-                        "Scripts\\",
-                        "scripts/",
-                        "scripts\\",
-                    };
-                    int tokenPos = -1;
-                    for (int i = 0; i < 4; ++i) {
-                        tokenPos = FindStringToken(modBuf, folderTest[i], 1);
-                        if (tokenPos >= 0)
-                            break;
-                    }
+        ModFile modFile;
+        modFile.path   = packPath;
+        modFile.offset = toc[pos + 0] | (toc[pos + 1] << 8) | (toc[pos + 2] << 16) | (toc[pos + 3] << 24);
+        modFile.size   = toc[pos + 4] | (toc[pos + 5] << 8) | (toc[pos + 6] << 16) | (toc[pos + 7] << 24);
+        byte compression = toc[pos + 8];
+        pos += 9;
 
-                    if (tokenPos >= 0) {
-                        char buffer[0x100];
-                        for (int i = StrLength(modBuf); i >= tokenPos; --i) {
-                            buffer[i - tokenPos] = modBuf[i] == '\\' ? '/' : modBuf[i];
-                        }
-
-                        // PrintLog(modBuf);
-                        std::string path(buffer);
-                        std::string modPath(modBuf);
-                        char pathLower[0x100];
-                        memset(pathLower, 0, sizeof(char) * 0x100);
-                        for (int c = 0; c < path.size(); ++c) {
-                            pathLower[c] = tolower(path.c_str()[c]);
-                        }
-
-                        info->fileMap.insert(std::pair<std::string, std::string>(pathLower, modBuf));
-                    }
-                }
-                else if (isDirectory(fullPath)) {
-                    dirs.push(fullPath);
-                }
-            }
+        if (compression != MODPACK_STORED) {
+            PrintLog("Unsupported compression for '%s' in mod pack '%s'", pathLower, packPath.c_str());
+            continue;
+        }
 
-            closedir(dir);
+        // loose files are scanned first, so they override anything in the pack
+        info->fileMap.insert(std::pair<std::string, ModFile>(pathLower, modFile));
+    }
+
+    free(toc);
+}
+
+void ScanModFolder(ModInfo *info)
+{
+    if (!info)
+        return;
+
+    char modBuf[0x100];
+    sprintf(modBuf, "%smods", modsPath);
+
+    std::string modPath = ResolvePath(modBuf);
+
+    const std::string modDir = modPath + "/" + info->folder;
+
+    info->fileMap.clear();
+    info->scanTimes.clear();
+    info->scanTimes.push_back(std::pair<std::string, time_t>(modDir, GetModifiedTime(modDir)));
+
+    // Check for Data/, Scripts/ & Videos/ replacements
+    ScanModSubFolder(info, ResolvePath(modDir + "/Data"), "Data");
+    ScanModSubFolder(info, ResolvePath(modDir + "/Scripts"), "Scripts");
+    ScanModSubFolder(info, ResolvePath(modDir + "/Videos"), "Videos");
+
+    info->packPath = "";
+    std::string packPath = modDir + "/" + MODPACK_NAME;
+    if (isRegularFile(packPath)) {
+        info->scanTimes.push_back(std::pair<std::string, time_t>(packPath, GetModifiedTime(packPath)));
+        ScanModPack(info, packPath);
+    }
+
+    modFileMapDirty = true;
+}
+
+void RefreshModFileMap()
+{
+    // only rescan mods that had a file added or removed since they were last scanned
+    for (int m = 0; m < (int)modList.size(); ++m) {
+        ModInfo *info = &modList[m];
+
+        bool changed = info->scanTimes.empty();
+        for (int d = 0; d < (int)info->scanTimes.size() && !changed; ++d) {
+            if (GetModifiedTime(info->scanTimes[d].first) != info->scanTimes[d].second)
+                changed = true;
         }
+
+        if (changed)
+            ScanModFolder(info);
     }
 
-    // Check for Videos/ replacements
-    std::string videosPath = ResolvePath(modDir + "/Videos");
+    if (!modFileMapDirty)
+        return;
 
-    if (pathExists(videosPath) && isDirectory(videosPath)) {
-        std::stack<std::string> dirs;
+    modFileMap.clear();
+    for (int m = 0; m < (int)modList.size(); ++m) {
+        if (!modList[m].active)
+            continue;
 
-            // Push the initial directory to the stack
-            dirs.push(dataPath);
+        // insert doesn't overwrite, so the first (highest priority) mod to provide a file wins
+        for (std::unordered_map<std::string, ModFile>::const_iterator iter = modList[m].fileMap.cbegin(); iter != modList[m].fileMap.cend();
+             ++iter) {
+            modFileMap.insert(*iter);
+        }
+    }
+    modFileMapDirty = false;
+}
 
-            while (!dirs.empty()) {
-                std::string currentDir = dirs.top();
+// Reads a mod file through LoadFile the way the loaders do: in full, after a seek, after a FileInfo save & restore and through a cursor
+bool ReadModFileForCheck(const char *path, std::vector<byte> *data)
+{
+    FileInfo info;
+    if (!LoadFile(path, &info))
+        return false;
 
-                // Pop the top directory from the stack
-                dirs.pop();
+    int size = info.vFileSize;
+    data->resize(size * 3 + 4);
+    FileRead(&(*data)[0], size);
+
+    SetFilePosition(size / 2);
+    int pos = (int)GetFilePosition();
+    memcpy(&(*data)[size], &pos, sizeof(int));
+    FileRead(&(*data)[size + 4], size - size / 2);
+
+    SetFilePosition(0);
+    FileRead(&(*data)[size * 2 - size / 2 + 4], size / 4);
+    GetFileInfo(&info);
+    CloseFile();
+    SetFileInfo(&info);
+    FileRead(&(*data)[size * 2 - size / 2 + size / 4 + 4], size - size / 4);
+
+    SetFilePosition(0);
+    FileCursor cursor;
+    bool loaded = LoadFileCursor(&cursor);
+    if (loaded)
+        data->insert(data->end(), cursor.data, cursor.data + cursor.size);
+    ReleaseFileCursor(&cursor);
+    CloseFile();
+    return loaded;
+}
 
-                DIR *dir = opendir(currentDir.c_str());
-                if (!dir) {
-                    continue;
-                }
+int BuildModPack(const char *folder)
+{
+    ModInfo loose;
+    loose.folder = folder;
+    ScanModFolder(&loose);
+
+    // only loose files go in, videos are streamed by path so they stay loose
+    std::vector<std::string> names;
+    for (std::unordered_map<std::string, ModFile>::const_iterator iter = loose.fileMap.cbegin(); iter != loose.fileMap.cend(); ++iter) {
+        if (iter->second.offset < 0 && iter->first.rfind("videos/", 0) != 0 && iter->first.size() < 0x100)
+            names.push_back(iter->first);
+    }
+    std::sort(names.begin(), names.end());
+    if (names.empty()) {
+        PrintLog("No loose files to pack in mod '%s'", folder);
+        return 1;
+    }
 
-                struct dirent *entry;
-                while ((entry = readdir(dir)) != NULL) {
-                    // Skip "." and ".."
-                    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-                        continue;
-                    }
+    std::vector<byte> pack;
+    pack.resize(0x10);
+    uint tocSize = 0;
+    for (size_t f = 0; f < names.size(); ++f) tocSize += 1 + (uint)names[f].size() + 9;
+
+    uint offset = 0x10 + tocSize;
+    for (size_t f = 0; f < names.size(); ++f) {
+        const std::string &name = names[f];
+        uint size               = (uint)loose.fileMap[name].size;
+        pack.push_back((byte)name.size());
+        pack.insert(pack.end(), name.begin(), name.end());
+        for (int b = 0; b < 4; ++b) pack.push_back((offset >> (b * 8)) & 0xFF);
+        for (int b = 0; b < 4; ++b) pack.push_back((size >> (b * 8)) & 0xFF);
+        pack.push_back(MODPACK_STORED);
+        offset += size;
+    }
 
-                    std::string fullPath = currentDir + "/" + entry->d_name;
-
-                    if (isRegularFile(fullPath)) {
-                        char modBuf[0x100];
-                        StrCopy(modBuf, fullPath.c_str());
-                        char folderTest[4][0x10] = {
-                            "Videos/",
-                            "Videos\\",
-                            "videos/",
-                            "videos\\",
-                        };
-                        int tokenPos = -1;
-                        for (int i = 0; i < 4; ++i) {
-                            tokenPos = FindStringToken(modBuf, folderTest[i], 1);
-                            if (tokenPos >= 0)
-                                break;
-                        }
-
-                        if (tokenPos >= 0) {
-                            char buffer[0x100];
-                            for (int i = StrLength(modBuf); i >= tokenPos; --i) {
-                                buffer[i - tokenPos] = modBuf[i] == '\\' ? '/' : modBuf[i];
-                            }
-
-                            // PrintLog(modBuf);
-                            std::string path(buffer);
-                            std::string modPath(modBuf);
-                            char pathLower[0x100];
-                            memset(pathLower, 0, sizeof(char) * 0x100);
-                            for (int c = 0; c < path.size(); ++c) {
-                                pathLower[c] = tolower(path.c_str()[c]);
-                            }
-
-                            info->fileMap.insert(std::pair<std::string, std::string>(pathLower, modBuf));
-                        }
-                    }
-                    else if (isDirectory(fullPath)) {
-                        dirs.push(fullPath);
-                    }
-                }
+    uint header[4] = { MODPACK_SIGNATURE, MODPACK_VERSION, (uint)names.size(), tocSize };
+    for (int h = 0; h < 4; ++h) {
+        for (int b = 0; b < 4; ++b) pack[h * 4 + b] = (header[h] >> (b * 8)) & 0xFF;
+    }
 
-                closedir(dir);
-            }
+    for (size_t f = 0; f < names.size(); ++f) {
+        const ModFile &file = loose.fileMap[names[f]];
+        FileIO *in          = fOpen(file.path.c_str(), "rb");
+        size_t start        = pack.size();
+        pack.resize(start + file.size);
+        if (!in || fRead(file.size ? &pack[start] : NULL, 1, file.size, in) != (size_t)file.size) {
+            PrintLog("Couldn't read '%s'", file.path.c_str());
+            if (in)
+                fClose(in);
+            return 1;
+        }
+        fClose(in);
+    }
+
+    char modBuf[0x100];
+    sprintf(modBuf, "%smods", modsPath);
+    std::string packPath = ResolvePath(modBuf) + "/" + folder + "/" + MODPACK_NAME;
+    FileIO *out          = fOpen(packPath.c_str(), "wb");
+    if (!out) {
+        PrintLog("Couldn't write '%s'", packPath.c_str());
+        return 1;
     }
+    fWrite(&pack[0], 1, pack.size(), out);
+    fClose(out);
+
+    // round trip: every packed file must read back through LoadFile exactly as its loose copy does
+    ModInfo packed;
+    ScanModPack(&packed, packPath);
+
+    std::unordered_map<std::string, ModFile> fileMap = modFileMap;
+    int prevActiveMod                                = activeMod;
+    activeMod                                        = -1;
+
+    int mismatches = 0;
+    for (size_t f = 0; f < names.size(); ++f) {
+        std::vector<byte> looseData, packedData;
+        modFileMap.clear();
+        modFileMap.insert(std::pair<std::string, ModFile>(names[f], loose.fileMap[names[f]]));
+        bool looseRead = ReadModFileForCheck(names[f].c_str(), &looseData);
+
+        modFileMap.clear();
+        if (packed.fileMap.count(names[f]))
+            modFileMap.insert(std::pair<std::string, ModFile>(names[f], packed.fileMap[names[f]]));
+        bool packedRead = ReadModFileForCheck(names[f].c_str(), &packedData);
+
+        if (!looseRead || !packedRead || looseData != packedData) {
+            PrintLog("Mod pack mismatch for '%s'", names[f].c_str());
+            ++mismatches;
+        }
+    }
+
+    modFileMap = fileMap;
+    activeMod  = prevActiveMod;
+
+    PrintLog("Packed %d files (%d bytes) into '%s', %d mismatched on read back", (int)names.size(), (int)pack.size(), packPath.c_str(),
+             mismatches);
+    return mismatches ? 1 : 0;
 }
 
 void SaveMods()
 {
+    modFileMapDirty = true;
+
     char modBuf[0x100];
     sprintf(modBuf, "%smods", modsPath);
     std::string modPath = ResolvePath(modBuf);
@@ -523,6 +653,10 @@ void SaveMods()
 
 void RefreshEngine()
 {
+    // the mod list may have been toggled or reordered, everything below has to load through the new priorities
+    modFileMapDirty = true;
+    RefreshModFileMap();
+
     // Reload entire engine
     Engine.LoadGameConfig("Data/Game/GameConfig.bin");
 #if RETRO_USING_SDL2
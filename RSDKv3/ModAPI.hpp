@@ -5,17 +5,41 @@
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <vector>
+#include <sys/types.h>
 #include <tinyxml2.h>
 
 #define PLAYERNAME_COUNT (0x10)
 
+// Optional single-file alternative to a mod's Data/, Scripts/ & Videos/ folders, placed next to mod.ini
+// Layout (little endian):
+//   uint signature ("RMPK"), ushort version, ushort flags, uint fileCount, uint tocSize
+//   fileCount * { byte nameLength, char name[nameLength], uint offset, uint size, byte compression }
+//   file data, each file starting at its offset from the start of the pack
+// Names are relative to the mod folder (e.g. "Data/Stages/Zone01/Act1.bin")
+#define MODPACK_NAME      "mod.pack"
+#define MODPACK_SIGNATURE (0x4B504D52)
+#define MODPACK_VERSION   (1)
+
+enum ModPackCompression {
+    MODPACK_STORED = 0,
+};
+
+struct ModFile {
+    std::string path; // loose file path, or the pack the file is stored in
+    int offset;       // offset of the file in the pack, -1 for loose files
+    int size;
+};
+
 struct ModInfo {
     std::string name;
     std::string desc;
     std::string author;
     std::string version;
-    std::map<std::string, std::string> fileMap;
+    std::unordered_map<std::string, ModFile> fileMap;
+    std::vector<std::pair<std::string, time_t>> scanTimes; // mtime of every directory seen by the last scan
     std::string folder;
+    std::string packPath;
     bool useScripts;
     int disableFocusPause;
     bool redirectSave;
@@ -27,6 +51,10 @@ struct ModInfo {
 extern std::vector<ModInfo> modList;
 extern int activeMod;
 
+// every active mod's fileMap merged into one, higher priority mods taking precedence
+extern std::unordered_map<std::string, ModFile> modFileMap;
+extern bool modFileMapDirty;
+
 extern char modsPath[0x100];
 
 extern bool redirectSave;
@@ -45,7 +73,27 @@ inline void SetActiveMod(int id) { activeMod = id; }
 void InitMods();
 bool LoadMod(ModInfo *info, std::string modsPath, std::string folder, bool active);
 void ScanModFolder(ModInfo *info);
+void RefreshModFileMap();
 void SaveMods();
+// Tool mode: packs a mod's loose Data/ & Scripts/ files into its mod.pack, then checks every entry reads back through LoadFile unchanged
+int BuildModPack(const char *folder);
+
+inline const ModFile *GetModFile(const char *pathLower)
+{
+    if (activeMod != -1) {
+        if (activeMod < (int)modList.size() && modList[activeMod].active) {
+            std::unordered_map<std::string, ModFile>::const_iterator iter = modList[activeMod].fileMap.find(pathLower);
+            if (iter != modList[activeMod].fileMap.cend())
+                return &iter->second;
+        }
+        return NULL;
+    }
+
+    std::unordered_map<std::string, ModFile>::const_iterator iter = modFileMap.find(pathLower);
+    if (iter != modFileMap.cend())
+        return &iter->second;
+    return NULL;
+}
 
 int OpenModMenu();
 
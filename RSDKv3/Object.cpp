@@ -1,10 +1,20 @@
 #include "RetroEngine.hpp"
 
+#if !RETRO_USE_ORIGINAL_CODE
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
 int objectLoop    = 0;
 int curObjectType = 0;
 Entity objectEntityList[ENTITY_COUNT];
 
 char typeNames[OBJECT_COUNT][0x40];
+#if !RETRO_USE_ORIGINAL_CODE
+int typeSymbols[OBJECT_COUNT];
+EntityHotFields objectHotList[ENTITY_COUNT];
+#endif
 
 int OBJECT_BORDER_X1       = 0x80;
 int OBJECT_BORDER_X2       = 0;
@@ -21,9 +31,225 @@ void SetObjectTypeName(const char *objectName, int objectID)
         ++objNameID;
     }
     typeNames[objectID][typeNameID] = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    typeSymbols[objectID] = InternSymbol(typeNames[objectID]);
+#if RETRO_USE_COMPILER
+    InvalidateTypeNameIndex();
+#endif
+#endif
     PrintLog("Set Object (%d) name to: %s", objectID, objectName);
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+// Pointers are hashed as list indices so the result is the same across builds
+uint GetPlayerStateHash(uint hash)
+{
+    for (int p = 0; p < PLAYER_COUNT; ++p) {
+        Player *player = &playerList[p];
+        hash           = HashStateBytes(hash, player, offsetof(Player, animationFile));
+
+        int refs[2];
+        refs[0] = player->animationFile ? (int)(player->animationFile - animationFileList) : -1;
+        refs[1] = player->boundEntity ? (int)(player->boundEntity - objectEntityList) : -1;
+        hash    = HashStateBytes(hash, refs, sizeof(refs));
+    }
+    return hash;
+}
+
+uint GetGameStateHash()
+{
+    uint hash = STATEHASH_SEED;
+    for (int e = 0; e < ENTITY_COUNT; ++e) hash = HashStateBytes(hash, &objectEntityList[e], ENTITY_HASHSIZE);
+    return GetPlayerStateHash(hash);
+}
+
+void SyncAllEntityHotFields()
+{
+    for (int e = 0; e < ENTITY_COUNT; ++e) SyncEntityHotFields(e);
+}
+
+// Reports (and repairs) slots where something wrote an entity without resyncing the mirror
+int VerifyEntityHotFields()
+{
+    int mismatches = 0;
+    int firstSlot  = -1;
+    for (int e = 0; e < ENTITY_COUNT; ++e) {
+        Entity *entity       = &objectEntityList[e];
+        EntityHotFields *hot = &objectHotList[e];
+        if (hot->XPos != entity->XPos || hot->YPos != entity->YPos || hot->type != entity->type || hot->priority != entity->priority
+            || hot->drawOrder != entity->drawOrder) {
+            if (firstSlot < 0)
+                firstSlot = e;
+            ++mismatches;
+            SyncEntityHotFields(e);
+        }
+    }
+
+    if (mismatches)
+        PrintLog("WARNING: %d entity hot field mismatches, first at slot %d (type %d)", mismatches, firstSlot, objectEntityList[firstSlot].type);
+    return mismatches;
+}
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+// Entities of isolated types (see ClassifyIsolatedObjects) are held back while ProcessObjects walks the list and updated
+// together, on the object workers, right before the next entity that isn't isolated. Anything they'd affect outside their
+// own entity (draw lists, script registers, activePlayer) is applied afterwards in entity order
+#define OBJECT_BATCH_MIN  (0x10) // smaller batches are cheaper to update on the main thread
+#define OBJECT_WORKER_MAX (3)
+
+bool objectReferencePass = false;
+
+int objectBatchSlots[ENTITY_COUNT];
+IsolatedScriptResult objectBatchResults[ENTITY_COUNT];
+int objectBatchCount = 0; // held back so far, only touched by the main thread
+
+int objectBatchSize    = 0; // the batch the workers are on, guarded by objectWorkerMutex like the rest
+int objectBatchNext    = 0;
+int objectBatchPending = 0;
+bool objectWorkersQuit = false;
+std::mutex objectWorkerMutex;
+std::condition_variable objectWorkerCond;
+std::condition_variable objectBatchDoneCond;
+std::vector<std::thread> objectWorkerThreads;
+
+std::vector<Entity> objectVerifyEntities;
+DrawListEntry objectVerifyDrawLists[DRAWLAYER_COUNT];
+
+static void RunObjectBatchJobs(std::unique_lock<std::mutex> &lock)
+{
+    while (objectBatchNext < objectBatchSize) {
+        int job = objectBatchNext++;
+        lock.unlock();
+        RunIsolatedObject(objectBatchSlots[job], &objectBatchResults[job]);
+        lock.lock();
+        if (--objectBatchPending == 0)
+            objectBatchDoneCond.notify_all();
+    }
+}
+
+static void ProcessObjectWorker()
+{
+    std::unique_lock<std::mutex> lock(objectWorkerMutex);
+    while (!objectWorkersQuit) {
+        RunObjectBatchJobs(lock);
+        objectWorkerCond.wait(lock);
+    }
+}
+
+static int GetObjectWorkerCount()
+{
+    static int cores = (int)std::thread::hardware_concurrency();
+    int count        = Engine.objectWorkers;
+    if (count < 0)
+        count = cores > 1 ? cores - 1 : 0;
+    return count < OBJECT_WORKER_MAX ? count : OBJECT_WORKER_MAX;
+}
+
+static void FlushObjectBatch()
+{
+    if (!objectBatchCount)
+        return;
+
+    if (objectBatchCount < OBJECT_BATCH_MIN) {
+        for (int j = 0; j < objectBatchCount; ++j) RunIsolatedObject(objectBatchSlots[j], &objectBatchResults[j]);
+    }
+    else {
+        if (objectWorkerThreads.empty()) {
+            objectWorkersQuit = false;
+            for (int w = GetObjectWorkerCount(); w > 0; --w) objectWorkerThreads.push_back(std::thread(ProcessObjectWorker));
+        }
+
+        std::unique_lock<std::mutex> lock(objectWorkerMutex);
+        objectBatchSize    = objectBatchCount;
+        objectBatchNext    = 0;
+        objectBatchPending = objectBatchCount;
+        objectWorkerCond.notify_all();
+        RunObjectBatchJobs(lock);
+        while (objectBatchPending) objectBatchDoneCond.wait(lock);
+        objectBatchSize = 0;
+    }
+
+    activePlayer = 0;
+    for (int j = 0; j < objectBatchCount; ++j) {
+        int slot             = objectBatchSlots[j];
+        EntityHotFields *hot = &objectHotList[slot];
+        MergeIsolatedScriptState(&objectBatchResults[j]);
+        if (hot->drawOrder < DRAWLAYER_COUNT)
+            drawListEntries[hot->drawOrder].entityRefs[drawListEntries[hot->drawOrder].listSize++] = slot;
+    }
+    objectBatchCount = 0;
+}
+
+void ReleaseObjectWorkers()
+{
+    {
+        std::unique_lock<std::mutex> lock(objectWorkerMutex);
+        objectWorkersQuit = true;
+        objectWorkerCond.notify_all();
+    }
+    for (std::thread &worker : objectWorkerThreads) worker.join();
+    objectWorkerThreads.clear();
+}
+
+// Runs the frame's object update with whichever of the native scripts and object workers are being verified turned off,
+// rewinds and runs it again the normal way. Both runs have to leave the entities, players, globals, script registers and
+// draw lists exactly the same
+void VerifyObjectFrame()
+{
+    if (!SaveStageSnapshot(STAGESNAPSHOT_VERIFY)) {
+        static bool reported = false;
+        if (!reported)
+            PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_ERROR, "ERROR: frame %u: couldn't snapshot the stage, objects aren't being verified",
+                             Engine.frameCount);
+        reported = true;
+        ProcessObjects();
+        return;
+    }
+
+    uint seed = rand(); // both runs have to see the same Rand results
+    const char *reference = Engine.verifyNativeScripts ? (Engine.verifyObjectWorkers ? "interpreted, serial" : "interpreted") : "serial";
+
+    objectReferencePass = true;
+    srand(seed);
+    ProcessObjects();
+    objectReferencePass = false;
+
+    uint referenceHash = HashStateBytes(GetGameStateHash(), globalVariables, sizeof(globalVariables));
+    referenceHash      = HashStateBytes(referenceHash, &scriptEng, sizeof(scriptEng));
+    objectVerifyEntities.assign(objectEntityList, objectEntityList + ENTITY_COUNT);
+    memcpy(objectVerifyDrawLists, drawListEntries, sizeof(drawListEntries));
+
+    if (!LoadStageSnapshot(STAGESNAPSHOT_VERIFY))
+        return; // the frame started loading a stage, keep the reference result
+
+    srand(seed);
+    ProcessObjects();
+
+    uint hash = HashStateBytes(GetGameStateHash(), globalVariables, sizeof(globalVariables));
+    hash      = HashStateBytes(hash, &scriptEng, sizeof(scriptEng));
+    int layer = 0;
+    while (layer < DRAWLAYER_COUNT && objectVerifyDrawLists[layer].listSize == drawListEntries[layer].listSize
+           && !memcmp(objectVerifyDrawLists[layer].entityRefs, drawListEntries[layer].entityRefs, drawListEntries[layer].listSize * sizeof(int)))
+        ++layer;
+    if (hash == referenceHash && layer == DRAWLAYER_COUNT)
+        return;
+
+    int slot = 0;
+    while (slot < ENTITY_COUNT && !memcmp(&objectVerifyEntities[slot], &objectEntityList[slot], ENTITY_HASHSIZE)) ++slot;
+
+    if (slot < ENTITY_COUNT)
+        PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_WARNING, "WARNING: frame %u: object update diverged from the %s run at entity %d (%s)",
+                         Engine.frameCount, reference, slot, typeNames[objectVerifyEntities[slot].type]);
+    else if (layer < DRAWLAYER_COUNT)
+        PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_WARNING, "WARNING: frame %u: object update diverged from the %s run in draw list %d",
+                         Engine.frameCount, reference, layer);
+    else
+        PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_WARNING,
+                         "WARNING: frame %u: object update diverged from the %s run in player, global or script state", Engine.frameCount, reference);
+}
+#endif
+
 void ProcessStartupObjects()
 {
     scriptFrameCount = 0;
@@ -45,12 +271,117 @@ void ProcessStartupObjects()
     }
     entity->type  = 0;
     curObjectType = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    SyncAllEntityHotFields();
+#endif
+}
+
+#if !RETRO_USE_ORIGINAL_CODE
+static void UpdateObjectStats(unsigned long long start)
+{
+    static int frames                 = 0;
+    static unsigned long long total   = 0;
+    static unsigned long long slowest = 0;
+
+    unsigned long long ticks = Time_GetPerformanceCounter() - start;
+    total += ticks;
+    if (ticks > slowest)
+        slowest = ticks;
+    if (++frames >= Engine.refreshRate) {
+        double tickMS = 1000.0 / Time_GetPerformanceFrequency();
+        PrintLog("Objects: %.3fms/frame in ProcessObjects (avg over %d frames), slowest %.3fms", total * tickMS / frames, frames, slowest * tickMS);
+        frames  = 0;
+        total   = 0;
+        slowest = 0;
+    }
 }
+#endif
 
 void ProcessObjects()
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    unsigned long long statsStart = Engine.showObjectStats ? Time_GetPerformanceCounter() : 0;
+#endif
     for (int i = 0; i < DRAWLAYER_COUNT; ++i) drawListEntries[i].listSize = 0;
 
+#if !RETRO_USE_ORIGINAL_CODE
+    if (Engine.verifyEntityHotList)
+        VerifyEntityHotFields();
+
+    bool parallel = !(objectReferencePass && Engine.verifyObjectWorkers) && GetObjectWorkerCount() > 0;
+    for (objectLoop = 0; objectLoop < ENTITY_COUNT; ++objectLoop) {
+        bool active = false;
+        int x = 0, y = 0;
+        EntityHotFields *hot = &objectHotList[objectLoop];
+        switch (hot->priority) {
+            case PRIORITY_BOUNDS:
+                x      = hot->XPos >> 16;
+                y      = hot->YPos >> 16;
+                active = x > xScrollOffset - OBJECT_BORDER_X1 && x < OBJECT_BORDER_X2 + xScrollOffset && y > yScrollOffset - OBJECT_BORDER_Y1
+                         && y < yScrollOffset + OBJECT_BORDER_Y2;
+                break;
+
+            case PRIORITY_ACTIVE:
+            case PRIORITY_ALWAYS: active = true; break;
+
+            case PRIORITY_XBOUNDS:
+                x      = hot->XPos >> 16;
+                active = x > xScrollOffset - OBJECT_BORDER_X1 && x < OBJECT_BORDER_X2 + xScrollOffset;
+                break;
+
+            case PRIORITY_BOUNDS_DESTROY:
+                x = hot->XPos >> 16;
+                y = hot->YPos >> 16;
+                if (x <= xScrollOffset - OBJECT_BORDER_X1 || x >= OBJECT_BORDER_X2 + xScrollOffset || y <= yScrollOffset - OBJECT_BORDER_Y1
+                    || y >= yScrollOffset + OBJECT_BORDER_Y2) {
+                    active = false;
+                    if (hot->type != OBJ_TYPE_BLANKOBJECT) {
+                        objectEntityList[objectLoop].type = OBJ_TYPE_BLANKOBJECT;
+                        hot->type                         = OBJ_TYPE_BLANKOBJECT;
+                    }
+                }
+                else {
+                    active = true;
+                }
+                break;
+
+            case PRIORITY_INACTIVE: active = false; break;
+
+            default: break;
+        }
+
+        if (active && hot->type > OBJ_TYPE_BLANKOBJECT) {
+            if (isolatedObjectTypes[hot->type] && parallel) {
+                objectBatchSlots[objectBatchCount++] = objectLoop;
+                continue;
+            }
+            FlushObjectBatch();
+
+            ObjectScript *scriptInfo = &objectScriptList[hot->type];
+            activePlayer             = 0;
+            if (scriptCode[scriptInfo->subMain.scriptCodePtr] > 0)
+                ProcessScript(scriptInfo->subMain.scriptCodePtr, scriptInfo->subMain.jumpTablePtr, SUB_MAIN);
+            if (scriptCode[scriptInfo->subPlayerInteraction.scriptCodePtr] > 0) {
+                while (activePlayer < activePlayerCount) {
+                    if (playerList[activePlayer].objectInteractions)
+                        ProcessScript(scriptInfo->subPlayerInteraction.scriptCodePtr, scriptInfo->subPlayerInteraction.jumpTablePtr,
+                                      SUB_PLAYERINTERACTION);
+                    ++activePlayer;
+                }
+            }
+
+            // the collision helpers the scripts call move the entity directly
+            SyncEntityHotFields(objectLoop);
+
+            if (hot->drawOrder < DRAWLAYER_COUNT)
+                drawListEntries[hot->drawOrder].entityRefs[drawListEntries[hot->drawOrder].listSize++] = objectLoop;
+        }
+    }
+    FlushObjectBatch();
+
+    if (Engine.showObjectStats)
+        UpdateObjectStats(statsStart);
+#else
     for (objectLoop = 0; objectLoop < ENTITY_COUNT; ++objectLoop) {
         bool active = false;
         int x = 0, y = 0;
@@ -107,12 +438,38 @@ void ProcessObjects()
                 drawListEntries[entity->drawOrder].entityRefs[drawListEntries[entity->drawOrder].listSize++] = objectLoop;
         }
     }
+#endif
 }
 
 void ProcessPausedObjects()
 {
     for (int i = 0; i < DRAWLAYER_COUNT; ++i) drawListEntries[i].listSize = 0;
 
+#if !RETRO_USE_ORIGINAL_CODE
+    for (objectLoop = 0; objectLoop < ENTITY_COUNT; ++objectLoop) {
+        EntityHotFields *hot = &objectHotList[objectLoop];
+
+        if (hot->priority == PRIORITY_ALWAYS && hot->type > OBJ_TYPE_BLANKOBJECT) {
+            ObjectScript *scriptInfo = &objectScriptList[hot->type];
+            activePlayer             = 0;
+            if (scriptCode[scriptInfo->subMain.scriptCodePtr] > 0)
+                ProcessScript(scriptInfo->subMain.scriptCodePtr, scriptInfo->subMain.jumpTablePtr, SUB_MAIN);
+            if (scriptCode[scriptInfo->subPlayerInteraction.scriptCodePtr] > 0) {
+                while (activePlayer < PLAYER_COUNT) {
+                    if (playerList[activePlayer].objectInteractions)
+                        ProcessScript(scriptInfo->subPlayerInteraction.scriptCodePtr, scriptInfo->subPlayerInteraction.jumpTablePtr,
+                                      SUB_PLAYERINTERACTION);
+                    ++activePlayer;
+                }
+            }
+
+            SyncEntityHotFields(objectLoop);
+
+            if (hot->drawOrder < DRAWLAYER_COUNT)
+                drawListEntries[hot->drawOrder].entityRefs[drawListEntries[hot->drawOrder].listSize++] = objectLoop;
+        }
+    }
+#else
     for (objectLoop = 0; objectLoop < ENTITY_COUNT; ++objectLoop) {
         Entity *entity = &objectEntityList[objectLoop];
 
@@ -134,4 +491,5 @@ void ProcessPausedObjects()
                 drawListEntries[entity->drawOrder].entityRefs[drawListEntries[entity->drawOrder].listSize++] = objectLoop;
         }
     }
+#endif
 }
\ No newline at end of file
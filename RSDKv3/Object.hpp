@@ -50,6 +50,35 @@ extern int curObjectType;
 extern Entity objectEntityList[ENTITY_COUNT];
 
 extern char typeNames[OBJECT_COUNT][0x40];
+#if !RETRO_USE_ORIGINAL_CODE
+extern int typeSymbols[OBJECT_COUNT];
+
+// The fields the object passes read for every slot, mirrored so deciding which entities run doesn't pull every Entity into the cache.
+// Code that writes an entity's type, priority, drawOrder or position outside of its own update has to resync it
+struct EntityHotFields {
+    int XPos;
+    int YPos;
+    byte type;
+    byte priority;
+    byte drawOrder;
+};
+
+extern EntityHotFields objectHotList[ENTITY_COUNT];
+
+inline void SyncEntityHotFields(int slot)
+{
+    Entity *entity       = &objectEntityList[slot];
+    EntityHotFields *hot = &objectHotList[slot];
+    hot->XPos            = entity->XPos;
+    hot->YPos            = entity->YPos;
+    hot->type            = entity->type;
+    hot->priority        = entity->priority;
+    hot->drawOrder       = entity->drawOrder;
+}
+
+void SyncAllEntityHotFields();
+int VerifyEntityHotFields();
+#endif
 
 extern int OBJECT_BORDER_X1;
 extern int OBJECT_BORDER_X2;
@@ -62,4 +91,25 @@ void ProcessPausedObjects();
 
 void SetObjectTypeName(const char *objectName, int objectID);
 
+#if !RETRO_USE_ORIGINAL_CODE
+#define STATEHASH_SEED  (0x811C9DC5)
+#define ENTITY_HASHSIZE (offsetof(Entity, frame) + sizeof(byte)) // leaves out the trailing padding
+
+// FNV-1a, used for replay and state trace checksums
+inline uint HashStateBytes(uint hash, const void *data, size_t size)
+{
+    const byte *bytes = (const byte *)data;
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 0x01000193;
+    return hash;
+}
+
+uint GetPlayerStateHash(uint hash);
+uint GetGameStateHash();
+
+extern bool objectReferencePass; // set while VerifyObjectFrame runs the update without the features being verified
+
+void VerifyObjectFrame();
+void ReleaseObjectWorkers();
+#endif
+
 #endif // !OBJECT_H
@@ -25,7 +25,23 @@ int paletteMode = 0;
 
 int texPaletteNum = 0;
 
+#if RETRO_USE_CONSTEXPR_TABLES
+constexpr std::array<uint, 0x10000> GeneratePalette16to32()
+{
+    std::array<uint, 0x10000> table = {};
+    for (int c = 0; c < 0x10000; ++c) {
+        int r    = (c & 0b1111100000000000) >> 8;
+        int g    = (c & 0b0000011111100000) >> 3;
+        int b    = (c & 0b0000000000011111) << 3;
+        table[c] = (r << 24) | (g << 16) | (b << 8) | (0xFF << 0);
+    }
+    return table;
+}
+
+constexpr std::array<uint, 0x10000> gfxPalette16to32 = GeneratePalette16to32();
+#else
 uint gfxPalette16to32[0x10000];
+#endif
 
 void LoadPalette(const char *filePath, int paletteID, int startPaletteIndex, int startIndex, int endIndex)
 {
@@ -40,7 +40,11 @@ extern int paletteMode;
 
 extern int texPaletteNum;
 
+#if RETRO_USE_CONSTEXPR_TABLES
+extern const std::array<uint, 0x10000> gfxPalette16to32;
+#else
 extern uint gfxPalette16to32[0x10000];
+#endif
 
 #define RGB888_TO_RGB5551(r, g, b) ((((b) >> 3) << 1) | (((g) >> 3) << 6) | (((r) >> 3) << 11) | 0) // used in mobile vers
 #define RGB888_TO_RGB565(r, g, b)  ((b) >> 3) | (((g) >> 2) << 5) | (((r) >> 3) << 11) // used in pc vers
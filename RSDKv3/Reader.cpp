@@ -115,7 +115,9 @@ bool LoadFile(const char *filePath, FileInfo *fileInfo)
     fileInfo->isMod = false;
     isModdedFile    = false;
 #endif
-    bool addPath = true;
+    bool addPath   = true;
+    int packOffset = -1;
+    int packSize   = 0;
     // Fixes ".ani" ".Ani" bug and any other case differences
     char pathLower[0x100];
     memset(pathLower, 0, sizeof(char) * 0x100);
@@ -124,23 +126,16 @@ bool LoadFile(const char *filePath, FileInfo *fileInfo)
     }
 
 #if RETRO_USE_MOD_LOADER
-    int m = activeMod != -1 ? activeMod : 0;
- 
-    for (; m < modList.size(); ++m) {
-        if (modList[m].active) {
-            std::map<std::string, std::string>::const_iterator iter = modList[m].fileMap.find(pathLower);
-            if (iter != modList[m].fileMap.cend()) {
-                StrCopy(filePathBuf, iter->second.c_str());
-                Engine.forceFolder   = true;
-                Engine.usingDataFile = false;
-                fileInfo->isMod      = true;
-                isModdedFile         = true;
-                addPath              = false;
-                break;
-            }
-        }
-        if (activeMod != -1)
-            break;
+    const ModFile *modFile = GetModFile(pathLower);
+    if (modFile) {
+        StrCopy(filePathBuf, modFile->path.c_str());
+        packOffset           = modFile->offset;
+        packSize             = modFile->size;
+        Engine.forceFolder   = true;
+        Engine.usingDataFile = false;
+        fileInfo->isMod      = true;
+        isModdedFile         = true;
+        addPath              = false;
     }
 
     if (forceUseScripts && !Engine.forceFolder) {
@@ -207,16 +202,26 @@ bool LoadFile(const char *filePath, FileInfo *fileInfo)
 
         StrCopy(fileInfo->fileName, filePathBuf);
         StrCopy(fileName, filePathBuf);
-        virtualFileOffset = 0;
-        fSeek(cFileHandle, 0, SEEK_END);
-        fileInfo->fileSize  = (int)fTell(cFileHandle);
-        fileInfo->vFileSize = fileInfo->fileSize;
-        fileSize            = fileInfo->fileSize;
-        vFileSize           = fileInfo->fileSize;
-        fSeek(cFileHandle, 0, SEEK_SET);
-        readPos                     = 0;
+        if (packOffset >= 0) {
+            // file stored in a mod pack, read it in place like a loose file that starts at packOffset
+            virtualFileOffset   = packOffset;
+            fileInfo->fileSize  = packSize;
+            fileInfo->vFileSize = packSize;
+            fileSize            = packOffset + packSize;
+            vFileSize           = packSize;
+        }
+        else {
+            virtualFileOffset = 0;
+            fSeek(cFileHandle, 0, SEEK_END);
+            fileInfo->fileSize  = (int)fTell(cFileHandle);
+            fileInfo->vFileSize = fileInfo->fileSize;
+            fileSize            = fileInfo->fileSize;
+            vFileSize           = fileInfo->fileSize;
+        }
+        fSeek(cFileHandle, virtualFileOffset, SEEK_SET);
+        readPos                     = virtualFileOffset;
         fileInfo->readPos           = readPos;
-        fileInfo->virtualFileOffset = 0;
+        fileInfo->virtualFileOffset = virtualFileOffset;
         fileInfo->eStringNo         = 0;
         fileInfo->eStringPosB       = 0;
         fileInfo->eStringPosA       = 0;
@@ -451,6 +456,26 @@ void FileRead(void *dest, int size)
             }
         }
         else {
+#if !RETRO_USE_ORIGINAL_CODE
+            while (size > 0) {
+                if (bufferPosition == readSize)
+                    FillFileBuffer();
+
+                int count = readSize - bufferPosition;
+                if (count <= 0) {
+                    // past the end, keep the old single byte behaviour
+                    *data++ = fileBuffer[bufferPosition++];
+                    size--;
+                    continue;
+                }
+                if (count > size)
+                    count = size;
+                memcpy(data, &fileBuffer[bufferPosition], count);
+                bufferPosition += count;
+                data += count;
+                size -= count;
+            }
+#else
             while (size > 0) {
                 if (bufferPosition == readSize)
                     FillFileBuffer();
@@ -458,6 +483,7 @@ void FileRead(void *dest, int size)
                 *data++ = fileBuffer[bufferPosition++];
                 size--;
             }
+#endif
         }
     }
     else {
@@ -465,6 +491,66 @@ void FileRead(void *dest, int size)
     }
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+bool streamFileCursors = false;
+
+bool LoadFileCursor(FileCursor *cursor)
+{
+    cursor->pos     = 0;
+    cursor->overrun = false;
+    cursor->size    = vFileSize - (int)GetFilePosition();
+    if (cursor->size < 0)
+        cursor->size = 0;
+
+    cursor->data = (byte *)malloc(cursor->size ? cursor->size : 1);
+    if (!cursor->data) {
+        cursor->size = 0;
+        return false;
+    }
+
+    FileRead(cursor->data, cursor->size);
+    return true;
+}
+
+void ReleaseFileCursor(FileCursor *cursor)
+{
+    if (cursor->data)
+        free(cursor->data);
+    cursor->data = NULL;
+    cursor->size = 0;
+    cursor->pos  = 0;
+}
+
+void OpenFileCursor(FileCursor *cursor)
+{
+    cursor->data    = NULL;
+    cursor->size    = 0;
+    cursor->pos     = 0;
+    cursor->overrun = false;
+    StrCopy(cursor->fileName, fileName);
+    cursor->start = Time_GetPerformanceCounter();
+    // if the buffer can't be allocated nothing has been read yet, so the cursor just streams instead
+    if (!streamFileCursors && LoadFileCursor(cursor))
+        CloseFile();
+}
+
+void CloseFileCursor(FileCursor *cursor)
+{
+    bool buffered = cursor->data != NULL;
+    int size      = buffered ? cursor->size : (int)GetFilePosition();
+    if (buffered)
+        ReleaseFileCursor(cursor);
+    else
+        CloseFile();
+    double time = (Time_GetPerformanceCounter() - cursor->start) * 1000.0 / Time_GetPerformanceFrequency();
+
+    if (cursor->overrun)
+        PrintLogCategory(LOGCAT_FILE, LOGLEVEL_WARNING, "WARNING: %s is truncated", cursor->fileName);
+    PrintLogCategory(LOGCAT_FILE, LOGLEVEL_DEBUG, "Parsed %s (%d bytes, %s) in %.3fms", cursor->fileName, size, buffered ? "buffered" : "streamed",
+                     time);
+}
+#endif
+
 void SetFileInfo(FileInfo *fileInfo)
 {
     Engine.forceFolder = false;
@@ -500,8 +586,9 @@ void SetFileInfo(FileInfo *fileInfo)
     else {
         StrCopy(fileName, fileInfo->fileName);
         cFileHandle       = fOpen(fileInfo->fileName, "rb");
-        virtualFileOffset = 0;
-        fileSize          = fileInfo->fileSize;
+        virtualFileOffset = fileInfo->virtualFileOffset;
+        vFileSize         = fileInfo->vFileSize;
+        fileSize          = virtualFileOffset + vFileSize;
         readPos           = fileInfo->readPos;
         fSeek(cFileHandle, readPos, SEEK_SET);
         FillFileBuffer();
@@ -518,7 +605,7 @@ size_t GetFilePosition()
     if (Engine.usingDataFile)
         return bufferPosition + readPos - readSize - virtualFileOffset;
     else
-        return bufferPosition + readPos - readSize;
+        return bufferPosition + readPos - readSize - virtualFileOffset;
 }
 
 void SetFilePosition(int newPos)
@@ -560,7 +647,7 @@ void SetFilePosition(int newPos)
         }
     }
     else {
-        readPos = newPos;
+        readPos = virtualFileOffset + newPos;
     }
     fSeek(cFileHandle, readPos, SEEK_SET);
     FillFileBuffer();
@@ -132,6 +132,127 @@ inline void GetFileInfo(FileInfo *fileInfo)
     fileInfo->isMod = isModdedFile;
 #endif
 }
+#if !RETRO_USE_ORIGINAL_CODE
+// Loaders parse the file LoadFile opened through a cursor. A buffered cursor holds the rest of the file, read (and decrypted)
+// in one go so there's no call per byte. A streaming cursor (data is NULL) passes every read on to FileRead, as the original loaders do
+struct FileCursor {
+    byte *data;
+    int size;
+    int pos;
+    bool overrun;
+    char fileName[0x100];
+    unsigned long long start;
+};
+
+extern bool streamFileCursors; // makes OpenFileCursor stream, so the loader benchmark can time both ways
+
+bool LoadFileCursor(FileCursor *cursor);
+void ReleaseFileCursor(FileCursor *cursor);
+
+// Starts parsing the open file, a buffered cursor closes it straight away
+void OpenFileCursor(FileCursor *cursor);
+// Closes the file or frees the buffer, then logs the parse time and any truncation
+void CloseFileCursor(FileCursor *cursor);
+
+// Reads past the end of a buffered cursor fill with zeroes and flag the cursor instead of touching memory outside the buffer
+inline bool CursorRead(FileCursor *cursor, void *dest, int size)
+{
+    if (size <= 0)
+        return true;
+    if (!cursor->data) {
+        FileRead(dest, size);
+        return true;
+    }
+    if (cursor->pos + size > cursor->size) {
+        int count = cursor->size - cursor->pos;
+        if (count > 0)
+            memcpy(dest, &cursor->data[cursor->pos], count);
+        else
+            count = 0;
+        memset((byte *)dest + count, 0, size - count);
+        cursor->pos     = cursor->size;
+        cursor->overrun = true;
+        return false;
+    }
+    memcpy(dest, &cursor->data[cursor->pos], size);
+    cursor->pos += size;
+    return true;
+}
+
+inline byte CursorReadByte(FileCursor *cursor)
+{
+    if (!cursor->data) {
+        byte value = 0;
+        FileRead(&value, 1);
+        return value;
+    }
+    if (cursor->pos >= cursor->size) {
+        cursor->overrun = true;
+        return 0;
+    }
+    return cursor->data[cursor->pos++];
+}
+
+inline ushort CursorReadU16BE(FileCursor *cursor)
+{
+    if (!cursor->data || cursor->pos + 2 > cursor->size) {
+        ushort value = CursorReadByte(cursor) << 8;
+        return value | CursorReadByte(cursor);
+    }
+    byte *data = &cursor->data[cursor->pos];
+    cursor->pos += 2;
+    return (data[0] << 8) | data[1];
+}
+
+inline ushort CursorReadU16LE(FileCursor *cursor)
+{
+    if (!cursor->data || cursor->pos + 2 > cursor->size) {
+        ushort value = CursorReadByte(cursor);
+        return value | (CursorReadByte(cursor) << 8);
+    }
+    byte *data = &cursor->data[cursor->pos];
+    cursor->pos += 2;
+    return data[0] | (data[1] << 8);
+}
+
+inline uint CursorReadU32LE(FileCursor *cursor)
+{
+    if (!cursor->data || cursor->pos + 4 > cursor->size) {
+        uint value = CursorReadByte(cursor);
+        value |= CursorReadByte(cursor) << 8;
+        value |= CursorReadByte(cursor) << 16;
+        return value | ((uint)CursorReadByte(cursor) << 24);
+    }
+    byte *data = &cursor->data[cursor->pos];
+    cursor->pos += 4;
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint)data[3] << 24);
+}
+
+inline void CursorReadU16BEArray(FileCursor *cursor, ushort *dest, int count)
+{
+    for (int i = 0; i < count; ++i) dest[i] = CursorReadU16BE(cursor);
+}
+
+inline void CursorReadU16LEArray(FileCursor *cursor, ushort *dest, int count)
+{
+    for (int i = 0; i < count; ++i) dest[i] = CursorReadU16LE(cursor);
+}
+
+inline void CursorSkip(FileCursor *cursor, int size)
+{
+    if (!cursor->data) {
+        byte skip = 0;
+        for (; size > 0; --size) FileRead(&skip, 1);
+        return;
+    }
+    cursor->pos += size;
+    if (cursor->pos > cursor->size) {
+        cursor->pos     = cursor->size;
+        cursor->overrun = true;
+    }
+}
+#endif
+
 void SetFileInfo(FileInfo *fileInfo);
 size_t GetFilePosition();
 void SetFilePosition(int newPos);
@@ -8,12 +8,44 @@
 #include <unistd.h>
 #endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+#include <thread>
+#endif
+
 bool usingCWD        = false;
 bool engineDebugMode = false;
 byte renderType      = RENDER_SW;
 
 RetroEngine Engine = RetroEngine();
 
+#if !RETRO_USE_ORIGINAL_CODE
+struct InitSpan {
+    const char *name;
+    unsigned long long time;
+};
+
+InitSpan initSpans[0x10];
+int initSpanCount                = 0;
+unsigned long long initSpanStart = 0;
+unsigned long long startupStart  = 0;
+
+// records the time since the previous span ended as a new span
+void MarkInitSpan(const char *name)
+{
+    unsigned long long time = Time_GetPerformanceCounter();
+    if (initSpanCount < (int)(sizeof(initSpans) / sizeof(InitSpan))) {
+        initSpans[initSpanCount].name = name;
+        initSpans[initSpanCount].time = time - initSpanStart;
+        ++initSpanCount;
+    }
+    initSpanStart = Time_GetPerformanceCounter();
+}
+
+inline double GetInitSpanMS(unsigned long long time) { return (time * 1000.0) / Time_GetPerformanceFrequency(); }
+#else
+#define MarkInitSpan(name)
+#endif
+
 inline int GetLowerRate(int intendRate, int targetRate)
 {
     int result   = 0;
@@ -45,6 +77,15 @@ bool ProcessEvents()
             Engine.gameMode = ENGINE_INITDEVMENU;
         }
     }
+
+#if !RETRO_USE_ORIGINAL_CODE
+    if (Engine.devMenu) {
+        if (CheckDevHotkey(Engine.saveStateKey))
+            SaveStageSnapshot(0);
+        if (CheckDevHotkey(Engine.loadStateKey))
+            LoadStageSnapshot(0);
+    }
+#endif
 #endif
 
 #if RETRO_USING_SDL1 || RETRO_USING_SDL2
@@ -133,6 +174,14 @@ bool ProcessEvents()
             }
 #endif
             case SDL_KEYDOWN:
+#if !RETRO_USE_ORIGINAL_CODE
+                if (Engine.devMenu) {
+                    if (Engine.sdlEvents.key.keysym.sym == Engine.saveStateKey)
+                        SaveStageSnapshot(0);
+                    else if (Engine.sdlEvents.key.keysym.sym == Engine.loadStateKey)
+                        LoadStageSnapshot(0);
+                }
+#endif
                 switch (Engine.sdlEvents.key.keysym.sym) {
                     default: break;
 
@@ -274,11 +323,37 @@ bool ProcessEvents()
 
 void RetroEngine::Init()
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    startupStart  = Time_GetPerformanceCounter();
+    initSpanStart = startupStart;
+    initSpanCount = 0;
+    InitSymbolTable();
+
+    // rand() state is per-thread on some CRTs, so it's only ever seeded here on the main thread
+    srand((unsigned)time(NULL));
+
+    // With RETRO_USE_CONSTEXPR_TABLES (the default) every phase below runs in order on this thread and the spans are timing only:
+    // CheckRSDKFile & LoadGameConfig read through the file map InitMods builds, InitMods finishes by reading the save & userdata,
+    // the render/audio devices go through the platform layer and LoadSfx has nothing to decode outside the SDL audio backends
+#if !RETRO_USE_CONSTEXPR_TABLES
+    // The lookup tables don't depend on anything else, so build them while the rest of init runs
+    unsigned long long tableTime = 0;
+    std::thread tableThread([&tableTime]() {
+        unsigned long long start = Time_GetPerformanceCounter();
+        CalculateTrigAngles();
+        GenerateBlendLookupTable();
+        tableTime = Time_GetPerformanceCounter() - start;
+    });
+#endif
+#else
     CalculateTrigAngles();
     GenerateBlendLookupTable();
+#endif
     InitUserdata();
+    MarkInitSpan("InitUserdata");
 #if RETRO_USE_MOD_LOADER
     InitMods();
+    MarkInitSpan("InitMods");
 #endif
     char dest[0x200];
 #if RETRO_PLATFORM == RETRO_UWP
@@ -303,16 +378,26 @@ void RetroEngine::Init()
     StrAdd(dest, Engine.dataFile);
 #endif
     CheckRSDKFile(dest);
+    MarkInitSpan("CheckRSDKFile");
 
     Engine.useFBTexture = Engine.scalingMode;
 
     gameMode = ENGINE_EXITGAME;
     running  = false;
     if (LoadGameConfig("Data/Game/GameConfig.bin")) {
+        MarkInitSpan("LoadGameConfig");
         if (InitRenderDevice()) {
+            MarkInitSpan("InitRenderDevice");
             if (InitAudioPlayback()) {
+                MarkInitSpan("InitAudioPlayback");
+#if !RETRO_USE_ORIGINAL_CODE
+                InitReplay(); // a replay overrides the starting stage
+                if (stateTracePath[0])
+                    InitStateTrace();
+#endif
                 InitFirstStage();
                 ClearScriptData();
+                MarkInitSpan("InitFirstStage");
                 initialised = true;
                 running     = true;
                 gameMode    = ENGINE_MAINGAME;
@@ -320,6 +405,25 @@ void RetroEngine::Init()
         }
     }
 
+#if !RETRO_USE_ORIGINAL_CODE
+#if !RETRO_USE_CONSTEXPR_TABLES
+    tableThread.join();
+    MarkInitSpan("Wait for lookup tables");
+#endif
+
+    if (replayMode != REPLAY_NONE)
+        srand(replaySeed);
+
+#if RETRO_USE_CONSTEXPR_TABLES
+    PrintLog("Startup time breakdown (serial):");
+#else
+    PrintLog("Startup time breakdown:");
+    PrintLog("    Lookup tables (async): %.3fms", GetInitSpanMS(tableTime));
+#endif
+    for (int i = 0; i < initSpanCount; ++i) PrintLog("    %s: %.3fms", initSpans[i].name, GetInitSpanMS(initSpans[i].time));
+    PrintLog("    Total: %.3fms", GetInitSpanMS(Time_GetPerformanceCounter() - startupStart));
+#endif
+
     // Calculate Skip frame
     int lower        = GetLowerRate(targetRefreshRate, refreshRate);
     renderFrameIndex = targetRefreshRate / lower;
@@ -367,15 +471,33 @@ void RetroEngine::Init()
 #endif
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+static void WaitUntilTicks(unsigned long long targetTicks)
+{
+    unsigned long long sleepMargin = Time_GetPerformanceFrequency() / 500;
+    unsigned long long curTicks    = 0;
+
+    // sleep while there's plenty of time left, then spin for the last couple of ms so the wake up is precise
+    while ((curTicks = Time_GetPerformanceCounter()) < targetTicks) {
+        if (targetTicks - curTicks > sleepMargin)
+            Time_Sleep(1);
+    }
+}
+#endif
+
 void RetroEngine::Run()
 {
     unsigned long long targetFreq = Time_GetPerformanceFrequency() / Engine.refreshRate;
     unsigned long long curTicks   = 0;
     unsigned long long prevTicks  = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    unsigned long long vsyncTicks = 0; // when the last blocking vsync wait returned
+#endif
 
     while (running && Gfx_MainLoop(Engine.glContext)) {
 #if !RETRO_USE_ORIGINAL_CODE
-        if (!vsync) {
+        // offline audio renders as fast as possible, the mixer is driven per tick instead of by the wall clock
+        if (!vsync && !offlineAudio && replayMode != REPLAY_PLAY) {
             curTicks = Time_GetPerformanceCounter();
             if (curTicks < prevTicks + targetFreq)
                 continue;
@@ -397,7 +519,32 @@ void RetroEngine::Run()
             }
         }
 
-        Gfx_FrameBegin();
+#if !RETRO_USE_ORIGINAL_CODE
+        // replays run headless: the frame is still built each tick but never submitted
+        bool present = replayMode != REPLAY_PLAY;
+#else
+        bool present = true;
+#endif
+        if (present)
+            Gfx_FrameBegin();
+
+#if !RETRO_USE_ORIGINAL_CODE
+#if RETRO_PLATFORM == RETRO_3DS
+        // citro3d waits for vblank when starting the frame rather than when presenting it
+        vsyncTicks = Time_GetPerformanceCounter();
+#endif
+        // Late latch: hold the update until lateLatchMS before the predicted vsync so input is sampled right before it's needed
+        if (vsync && Engine.lateLatchMS > 0 && vsyncTicks && !offlineAudio && replayMode != REPLAY_PLAY) {
+            unsigned long long latchTicks = Time_GetPerformanceFrequency() * Engine.lateLatchMS / 1000;
+            if (latchTicks < targetFreq)
+                WaitUntilTicks(vsyncTicks + targetFreq - latchTicks);
+#if RETRO_USING_SDL1 || RETRO_USING_SDL2
+            SDL_PumpEvents();
+#else
+            Gfx_PollEvents();
+#endif
+        }
+#endif
 
         if (!(Engine.focusState & 1)) {
             for (int s = 0; s < gameSpeed; ++s) {
@@ -467,15 +614,41 @@ void RetroEngine::Run()
                         default: break;
                     }
                 }
+
+#if !RETRO_USE_ORIGINAL_CODE
+                if (offlineAudio)
+                    ProcessOfflineAudio();
+                if (replayMode != REPLAY_NONE)
+                    ProcessReplayTick();
+                if (stateTraceActive)
+                    ProcessStateTrace();
+                UpdateSymbolStats();
+                UpdateSortStats();
+#endif
             }
         }
 
-        FlipScreen();
+        if (present) {
+            FlipScreen();
 
 #if RETRO_USING_OPENGL && RETRO_USING_SDL2
-        SDL_GL_SwapWindow(Engine.window);
+            SDL_GL_SwapWindow(Engine.window);
 #elif RETRO_PLATFORM == RETRO_3DS || RETRO_PLATFORM == RETRO_3DSSIM
-        Gfx_FrameEnd(Engine.glContext);
+            Gfx_FrameEnd(Engine.glContext);
+#endif
+        }
+
+#if !RETRO_USE_ORIGINAL_CODE
+        curTicks = Time_GetPerformanceCounter();
+#if RETRO_PLATFORM != RETRO_3DS
+        vsyncTicks = curTicks;
+#endif
+        UpdateInputLatency(curTicks);
+
+        if (startupStart) {
+            PrintLog("Startup: first frame presented after %.3fms", GetInitSpanMS(Time_GetPerformanceCounter() - startupStart));
+            startupStart = 0;
+        }
 #endif
         frameStep      = false;
         Engine.message = MESSAGE_NONE;
@@ -491,6 +664,12 @@ void RetroEngine::Run()
 #endif
     }
 
+#if !RETRO_USE_ORIGINAL_CODE
+    ReleaseReplay();
+    ReleaseStateTrace();
+    ReleaseStageSnapshots();
+    ReleaseObjectWorkers();
+#endif
     ReleaseAudioDevice();
     StopVideoPlayback();
     ReleaseRenderDevice();
@@ -498,6 +677,10 @@ void RetroEngine::Run()
 #if RETRO_USE_MOD_LOADER
     SaveMods();
 #endif
+#if !RETRO_USE_ORIGINAL_CODE
+    ReleaseSaveWriter(); // waits for anything still queued
+    ReleaseLogWriter();
+#endif
 
 #if RETRO_USING_SDL1 || RETRO_USING_SDL2 || RETRO_USING_SDL1_AUDIO || RETRO_USING_SDL2_AUDIO
     SDL_Quit();
@@ -603,6 +786,9 @@ void RetroEngine::LoadXMLVariables()
                                 varValue = GetXMLAttributeValueInt(valAttr);
 
                             StrCopy(globalVariableNames[globalVariablesCount], varName);
+#if !RETRO_USE_ORIGINAL_CODE
+                            globalVariableSymbols[globalVariablesCount] = InternSymbol(varName);
+#endif
                             globalVariables[globalVariablesCount] = varValue;
                             globalVariablesCount++;
 
@@ -1030,6 +1216,9 @@ bool RetroEngine::LoadGameConfig(const char *filePath)
             FileRead(&fileBuffer, 1);
             FileRead(&globalVariableNames[v], fileBuffer);
             globalVariableNames[v][fileBuffer] = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+            globalVariableSymbols[v] = InternSymbol(globalVariableNames[v]);
+#endif
 
             // Read Variable Value
             FileRead(&fileBuffer2, 1);
@@ -1258,6 +1447,9 @@ void RetroEngine::Callback(int callbackID)
                     objectEntityList[9].type      = o;
                     objectEntityList[9].drawOrder = 6;
                     objectEntityList[9].priority  = PRIORITY_ALWAYS;
+#if !RETRO_USE_ORIGINAL_CODE
+                    SyncEntityHotFields(9);
+#endif
                     if (activeStageList == STAGELIST_SPECIAL)
                         stageLayouts[0].type = LAYER_3DFLOOR;
                     for (int s = 0; s < globalSFXCount + stageSFXCount; ++s) {
@@ -14,6 +14,16 @@
 #define RETRO_USE_MOD_LOADER (!RETRO_USE_ORIGINAL_CODE && 1)
 #endif
 
+// Generates the trig, blend & palette lookup tables at compile time rather than on startup
+// clang & MSVC's default constexpr step limits are too low for the 64K entry tables, so they still generate them at runtime
+#ifndef RETRO_USE_CONSTEXPR_TABLES
+#if defined(__GNUC__) && !defined(__clang__)
+#define RETRO_USE_CONSTEXPR_TABLES (!RETRO_USE_ORIGINAL_CODE && 1)
+#else
+#define RETRO_USE_CONSTEXPR_TABLES (0)
+#endif
+#endif
+
 // Forces all DLC flags to be disabled, this should be enabled in any public releases
 #ifndef RSDK_AUTOBUILD
 #define RSDK_AUTOBUILD (0)
@@ -28,6 +38,9 @@
 #if RETRO_USE_MOD_LOADER
 #include <regex>
 #endif
+#if RETRO_USE_CONSTEXPR_TABLES
+#include <array>
+#endif
 
 // ================
 // STANDARD TYPES
@@ -503,8 +516,23 @@ public:
     char startSceneFolder[0x10];
     char startSceneID[0x10];
 
-    bool showPaletteOverlay = false;
-    bool useHQModes         = true;
+    bool showPaletteOverlay  = false;
+    bool useHQModes          = true;
+    bool showInputLatency    = false;
+    bool showSymbolStats     = false;
+    bool showSortStats       = false;
+    bool showObjectStats     = false;
+    bool useScriptCache      = true;
+    bool verifyScriptCache   = false;
+    bool verifyEntityHotList = false;
+    bool useNativeScripts    = true;
+    bool verifyNativeScripts = false;
+    int objectWorkers        = -1; // -1 picks one per spare core
+    bool verifyObjectWorkers = false;
+    int logLevel             = LOGLEVEL_DEBUG;
+    int lateLatchMS          = 0;
+    int saveStateKey         = 0; // dev hotkeys for stage snapshot slot 0
+    int loadStateKey         = 0;
 #endif
 
     void Init();
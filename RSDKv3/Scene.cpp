@@ -183,7 +183,7 @@ void ProcessStage(void)
             Engine.frameCount = 0;
             stageMode         = STAGEMODE_NORMAL;
 #if RETRO_USE_MOD_LOADER
-            for (int m = 0; m < modList.size(); ++m) ScanModFolder(&modList[m]);
+            RefreshModFileMap();
 #endif
             ResetBackgroundSettings();
             LoadStageFiles();
@@ -230,6 +230,10 @@ void ProcessStage(void)
                     gfxIndexSizeOpaque[eye]  = 0;
                 }
             }
+#if !RETRO_USE_ORIGINAL_CODE
+            if (Engine.devMenu || Engine.verifyNativeScripts || Engine.verifyObjectWorkers)
+                CaptureStageBaseline();
+#endif
             break;
 
         case STAGEMODE_NORMAL:
@@ -266,7 +270,14 @@ void ProcessStage(void)
             }
 
             // Update
+#if !RETRO_USE_ORIGINAL_CODE
+            if (Engine.verifyNativeScripts || Engine.verifyObjectWorkers)
+                VerifyObjectFrame();
+            else
+                ProcessObjects();
+#else
             ProcessObjects();
+#endif
 
             if (cameraTarget > -1) {
                 if (cameraEnabled == 1) {
@@ -356,6 +367,11 @@ void LoadStageFiles(void)
 #endif
         ClearScriptData();
         for (int i = SURFACE_COUNT; i > 0; i--) RemoveGraphicsFile((char *)"", i - 1);
+#if !RETRO_USE_ORIGINAL_CODE
+        // the last stage's animations, sheets and type names are gone, so only the engine's and the globals' symbols are kept
+        InitSymbolTable();
+        for (int v = 0; v < globalVariablesCount; ++v) globalVariableSymbols[v] = InternSymbol(globalVariableNames[v]);
+#endif
 
 #if RETRO_USE_MOD_LOADER
         loadGlobalScripts = false;
@@ -568,6 +584,11 @@ void LoadStageFiles(void)
             }
             CloseFile();
         }
+#if !RETRO_USE_ORIGINAL_CODE
+        BindNativeScripts();
+        ClassifyIsolatedObjects();
+#endif
+
         FileInfo info;
         if (LoadStageFile("16x16Tiles.gif", stageListPosition, &info)) {
             CloseFile();
@@ -625,6 +646,79 @@ int LoadStageFile(const char *filePath, int stageID, FileInfo *info)
 void LoadActLayout()
 {
     FileInfo info;
+#if !RETRO_USE_ORIGINAL_CODE
+    if (LoadActFile(".bin", stageListPosition, &info)) {
+        FileCursor cursor;
+        OpenFileCursor(&cursor);
+
+        byte length    = CursorReadByte(&cursor);
+        titleCardWord2 = (byte)length;
+        CursorRead(&cursor, titleCardText, length);
+        for (int i = 0; i < length; i++) {
+            if (titleCardText[i] == '-')
+                titleCardWord2 = (byte)(i + 1);
+        }
+        titleCardText[length] = '\0';
+
+        // READ TILELAYER
+        CursorRead(&cursor, activeTileLayers, 4);
+        tLayerMidPoint = CursorReadByte(&cursor);
+
+        stageLayouts[0].xsize = CursorReadByte(&cursor);
+        stageLayouts[0].ysize = CursorReadByte(&cursor);
+        xBoundary1            = 0;
+        newXBoundary1         = 0;
+        yBoundary1            = 0;
+        newYBoundary1         = 0;
+        xBoundary2            = stageLayouts[0].xsize << 7;
+        yBoundary2            = stageLayouts[0].ysize << 7;
+        waterLevel            = yBoundary2 + 128;
+        newXBoundary2         = stageLayouts[0].xsize << 7;
+        newYBoundary2         = stageLayouts[0].ysize << 7;
+
+        memset(stageLayouts[0].tiles, 0, sizeof(stageLayouts[0].tiles));
+        for (int y = 0; y < stageLayouts[0].ysize; ++y)
+            CursorReadU16BEArray(&cursor, &stageLayouts[0].tiles[y * 0x100], stageLayouts[0].xsize);
+
+        // READ TYPENAMES
+        int typenameCnt = CursorReadByte(&cursor);
+        for (int i = 0; i < typenameCnt; ++i) CursorSkip(&cursor, CursorReadByte(&cursor));
+
+        // READ OBJECTS
+        int ObjectCount = CursorReadU16BE(&cursor);
+
+        // layout objects fill 32 up to TEMPENTITY_START, anything past that would overwrite the temp slots and beyond
+        if (ObjectCount > TEMPENTITY_START - 32) {
+            PrintLog("WARNING: object count %d exceeds the object limit, only the first %d are loaded", ObjectCount, TEMPENTITY_START - 32);
+            ObjectCount = TEMPENTITY_START - 32;
+        }
+
+#if RETRO_USE_MOD_LOADER
+        int offsetCount = 0;
+        for (int m = 0; m < modObjCount; ++m)
+            if (modScriptFlags[m])
+                ++offsetCount;
+#endif
+
+        Entity *object = &objectEntityList[32];
+        for (int i = 0; i < ObjectCount; ++i) {
+            object->type = CursorReadByte(&cursor);
+
+#if RETRO_USE_MOD_LOADER
+            if (loadGlobalScripts && offsetCount && object->type > globalObjCount)
+                object->type += offsetCount; // offset it by our mod count
+#endif
+
+            object->propertyValue = CursorReadByte(&cursor);
+            object->XPos          = CursorReadU16BE(&cursor) << 16;
+            object->YPos          = CursorReadU16BE(&cursor) << 16;
+
+            ++object;
+        }
+        stageLayouts[0].type = LAYER_HSCROLL;
+        CloseFileCursor(&cursor);
+    }
+#else
     if (LoadActFile(".bin", stageListPosition, &info)) {
         byte length = 0;
         FileRead(&length, 1);
@@ -682,11 +776,6 @@ void LoadActLayout()
         FileRead(&fileBuffer, 1);
         ObjectCount = (ObjectCount << 8) + fileBuffer;
 
-#if !RETRO_USE_ORIGINAL_CODE
-        if (ObjectCount > 0x400)
-            PrintLog("WARNING: object count %d exceeds the object limit", ObjectCount);
-#endif
-
 #if RETRO_USE_MOD_LOADER
         int offsetCount = 0;
         for (int m = 0; m < modObjCount; ++m)
@@ -724,6 +813,8 @@ void LoadActLayout()
         stageLayouts[0].type = LAYER_HSCROLL;
         CloseFile();
     }
+
+#endif
 }
 void LoadStageBackground()
 {
@@ -833,6 +924,29 @@ void LoadStageChunks()
     FileInfo info;
     byte entry[3];
 
+#if !RETRO_USE_ORIGINAL_CODE
+    if (LoadStageFile("128x128Tiles.bin", stageListPosition, &info)) {
+        FileCursor cursor;
+        OpenFileCursor(&cursor);
+
+        for (int i = 0; i < CHUNKTILE_COUNT; ++i) {
+            CursorRead(&cursor, entry, 3);
+
+            tiles128x128.visualPlane[i] = (byte)((entry[0] >> 4) & 3);
+            tiles128x128.direction[i]   = (byte)((entry[0] >> 2) & 3);
+            tiles128x128.tileIndex[i]   = entry[1] + ((entry[0] & 3) << 8);
+
+            if (renderType == RENDER_SW)
+                tiles128x128.gfxDataPos[i] = tiles128x128.tileIndex[i] << 8;
+            else if (renderType == RENDER_HW)
+                tiles128x128.gfxDataPos[i] = tiles128x128.tileIndex[i] << 2;
+
+            tiles128x128.collisionFlags[0][i] = entry[2] >> 4;
+            tiles128x128.collisionFlags[1][i] = entry[2] & 0xF;
+        }
+        CloseFileCursor(&cursor);
+    }
+#else
     if (LoadStageFile("128x128Tiles.bin", stageListPosition, &info)) {
         for (int i = 0; i < CHUNKTILE_COUNT; ++i) {
             FileRead(&entry, 3);
@@ -856,10 +970,174 @@ void LoadStageChunks()
         }
         CloseFile();
     }
+#endif
 }
 void LoadStageCollisions()
 {
     FileInfo info;
+#if !RETRO_USE_ORIGINAL_CODE
+    if (LoadStageFile("CollisionMasks.bin", stageListPosition, &info)) {
+        FileCursor cursor;
+        OpenFileCursor(&cursor);
+
+        byte fileBuffer = 0;
+        int tileIndex   = 0;
+        for (int t = 0; t < 1024; ++t) {
+            for (int p = 0; p < 2; ++p) {
+                fileBuffer                  = CursorReadByte(&cursor);
+                bool isCeiling              = fileBuffer >> 4;
+                collisionMasks[p].flags[t]  = fileBuffer & 0xF;
+                collisionMasks[p].angles[t] = CursorReadU32LE(&cursor);
+
+                if (isCeiling) // Ceiling Tile
+                {
+                    for (int c = 0; c < TILE_SIZE; c += 2) {
+                        fileBuffer = CursorReadByte(&cursor);
+                        collisionMasks[p].roofMasks[c + tileIndex]     = fileBuffer >> 4;
+                        collisionMasks[p].roofMasks[c + tileIndex + 1] = fileBuffer & 0xF;
+                    }
+
+                    // Has Collision (Pt 1)
+                    fileBuffer = CursorReadByte(&cursor);
+                    int id = 1;
+                    for (int c = 0; c < TILE_SIZE / 2; ++c) {
+                        if (fileBuffer & id) {
+                            collisionMasks[p].floorMasks[c + tileIndex + 8] = 0;
+                        }
+                        else {
+                            collisionMasks[p].floorMasks[c + tileIndex + 8] = 0x40;
+                            collisionMasks[p].roofMasks[c + tileIndex + 8]  = -0x40;
+                        }
+                        id <<= 1;
+                    }
+
+                    // Has Collision (Pt 2)
+                    fileBuffer = CursorReadByte(&cursor);
+                    id = 1;
+                    for (int c = 0; c < TILE_SIZE / 2; ++c) {
+                        if (fileBuffer & id) {
+                            collisionMasks[p].floorMasks[c + tileIndex] = 0;
+                        }
+                        else {
+                            collisionMasks[p].floorMasks[c + tileIndex] = 0x40;
+                            collisionMasks[p].roofMasks[c + tileIndex]  = -0x40;
+                        }
+                        id <<= 1;
+                    }
+
+                    // LWall rotations
+                    for (int c = 0; c < TILE_SIZE; ++c) {
+                        int h = 0;
+                        while (h > -1) {
+                            if (h >= TILE_SIZE) {
+                                collisionMasks[p].lWallMasks[c + tileIndex] = 0x40;
+                                h                                           = -1;
+                            }
+                            else if (c > collisionMasks[p].roofMasks[h + tileIndex]) {
+                                ++h;
+                            }
+                            else {
+                                collisionMasks[p].lWallMasks[c + tileIndex] = h;
+                                h                                           = -1;
+                            }
+                        }
+                    }
+
+                    // RWall rotations
+                    for (int c = 0; c < TILE_SIZE; ++c) {
+                        int h = TILE_SIZE - 1;
+                        while (h < TILE_SIZE) {
+                            if (h <= -1) {
+                                collisionMasks[p].rWallMasks[c + tileIndex] = -0x40;
+                                h                                           = TILE_SIZE;
+                            }
+                            else if (c > collisionMasks[p].roofMasks[h + tileIndex]) {
+                                --h;
+                            }
+                            else {
+                                collisionMasks[p].rWallMasks[c + tileIndex] = h;
+                                h                                           = TILE_SIZE;
+                            }
+                        }
+                    }
+                }
+                else // Regular Tile
+                {
+                    for (int c = 0; c < TILE_SIZE; c += 2) {
+                        fileBuffer = CursorReadByte(&cursor);
+                        collisionMasks[p].floorMasks[c + tileIndex]     = fileBuffer >> 4;
+                        collisionMasks[p].floorMasks[c + tileIndex + 1] = fileBuffer & 0xF;
+                    }
+                    fileBuffer = CursorReadByte(&cursor);
+                    int id = 1;
+                    for (int c = 0; c < TILE_SIZE / 2; ++c) // HasCollision
+                    {
+                        if (fileBuffer & id) {
+                            collisionMasks[p].roofMasks[c + tileIndex + 8] = 0xF;
+                        }
+                        else {
+                            collisionMasks[p].floorMasks[c + tileIndex + 8] = 0x40;
+                            collisionMasks[p].roofMasks[c + tileIndex + 8]  = -0x40;
+                        }
+                        id <<= 1;
+                    }
+
+                    fileBuffer = CursorReadByte(&cursor);
+                    id = 1;
+                    for (int c = 0; c < TILE_SIZE / 2; ++c) // HasCollision (pt 2)
+                    {
+                        if (fileBuffer & id) {
+                            collisionMasks[p].roofMasks[c + tileIndex] = 0xF;
+                        }
+                        else {
+                            collisionMasks[p].floorMasks[c + tileIndex] = 0x40;
+                            collisionMasks[p].roofMasks[c + tileIndex]  = -0x40;
+                        }
+                        id <<= 1;
+                    }
+
+                    // LWall rotations
+                    for (int c = 0; c < TILE_SIZE; ++c) {
+                        int h = 0;
+                        while (h > -1) {
+                            if (h >= TILE_SIZE) {
+                                collisionMasks[p].lWallMasks[c + tileIndex] = 0x40;
+                                h                                           = -1;
+                            }
+                            else if (c < collisionMasks[p].floorMasks[h + tileIndex]) {
+                                ++h;
+                            }
+                            else {
+                                collisionMasks[p].lWallMasks[c + tileIndex] = h;
+                                h                                           = -1;
+                            }
+                        }
+                    }
+
+                    // RWall rotations
+                    for (int c = 0; c < TILE_SIZE; ++c) {
+                        int h = TILE_SIZE - 1;
+                        while (h < TILE_SIZE) {
+                            if (h <= -1) {
+                                collisionMasks[p].rWallMasks[c + tileIndex] = -0x40;
+                                h                                           = TILE_SIZE;
+                            }
+                            else if (c < collisionMasks[p].floorMasks[h + tileIndex]) {
+                                --h;
+                            }
+                            else {
+                                collisionMasks[p].rWallMasks[c + tileIndex] = h;
+                                h                                           = TILE_SIZE;
+                            }
+                        }
+                    }
+                }
+            }
+            tileIndex += 16;
+        }
+        CloseFileCursor(&cursor);
+    }
+#else
     if (LoadStageFile("CollisionMasks.bin", stageListPosition, &info)) {
 
         byte fileBuffer = 0;
@@ -1026,6 +1304,7 @@ void LoadStageCollisions()
         }
         CloseFile();
     }
+#endif
 }
 void LoadStageGIFFile(int stageID)
 {
@@ -1778,3 +2057,387 @@ void SetPlayerLockedScreenPosition(Player *player)
         }
     }
 }
+
+#if !RETRO_USE_ORIGINAL_CODE
+struct SnapshotRegion {
+    void *data;
+    int size;
+};
+
+struct StageSnapshot {
+    byte *arena; // flat regions, then (region << 16 | chunk) keys each followed by a chunk
+    int deltaSize;
+    uint stageSerial;
+    bool valid;
+};
+
+#define SNAPSHOT_REGION_COUNT       (0x80)
+#define SNAPSHOT_DELTA_REGION_COUNT (LAYER_COUNT + 2)
+
+SnapshotRegion snapshotRegions[SNAPSHOT_REGION_COUNT];
+int snapshotRegionCount = 0;
+int snapshotFlatSize    = 0;
+
+// Large buffers that only change in small spots, stored as chunks that differ from the stage as it was loaded
+SnapshotRegion snapshotDeltaRegions[SNAPSHOT_DELTA_REGION_COUNT];
+int snapshotDeltaRegionCount = 0;
+int snapshotBaselineSize     = 0;
+
+byte *snapshotBaseline   = NULL;
+uint snapshotStageSerial = 0;
+StageSnapshot stageSnapshots[STAGESNAPSHOT_COUNT + 1]; // the user slots, then the verify slot
+
+// The verify slot only takes snapshots while a verify mode is using it, so its arena is never allocated otherwise
+static bool IsSnapshotSlotValid(int slot)
+{
+    if (slot == STAGESNAPSHOT_VERIFY)
+        return Engine.verifyNativeScripts || Engine.verifyObjectWorkers;
+    return slot >= 0 && slot < STAGESNAPSHOT_COUNT;
+}
+
+#define AddSnapshotRegion(var) AddSnapshotRegionPtr(&(var), sizeof(var))
+
+static void AddSnapshotRegionPtr(void *data, int size)
+{
+    snapshotRegions[snapshotRegionCount].data   = data;
+    snapshotRegions[snapshotRegionCount++].size = size;
+    snapshotFlatSize += size;
+}
+
+static void AddSnapshotDeltaRegion(void *data, int size)
+{
+    snapshotDeltaRegions[snapshotDeltaRegionCount].data   = data;
+    snapshotDeltaRegions[snapshotDeltaRegionCount++].size = size;
+    snapshotBaselineSize += size;
+}
+
+// Everything a tick can change while a stage is running. Pointers are kept as-is, snapshots never outlive the loaded stage
+static void SetupSnapshotRegions()
+{
+    if (snapshotRegionCount)
+        return;
+
+    AddSnapshotRegion(stageMode);
+    AddSnapshotRegion(cameraTarget);
+    AddSnapshotRegion(cameraStyle);
+    AddSnapshotRegion(cameraEnabled);
+    AddSnapshotRegion(cameraAdjustY);
+    AddSnapshotRegion(xScrollOffset);
+    AddSnapshotRegion(yScrollOffset);
+    AddSnapshotRegion(yScrollA);
+    AddSnapshotRegion(yScrollB);
+    AddSnapshotRegion(xScrollA);
+    AddSnapshotRegion(xScrollB);
+    AddSnapshotRegion(yScrollMove);
+    AddSnapshotRegion(cameraShakeX);
+    AddSnapshotRegion(cameraShakeY);
+    AddSnapshotRegion(cameraLag);
+    AddSnapshotRegion(cameraLagStyle);
+    AddSnapshotRegion(xBoundary1);
+    AddSnapshotRegion(newXBoundary1);
+    AddSnapshotRegion(yBoundary1);
+    AddSnapshotRegion(newYBoundary1);
+    AddSnapshotRegion(xBoundary2);
+    AddSnapshotRegion(yBoundary2);
+    AddSnapshotRegion(newXBoundary2);
+    AddSnapshotRegion(newYBoundary2);
+    AddSnapshotRegion(waterLevel);
+    AddSnapshotRegion(waterDrawPos);
+    AddSnapshotRegion(SCREEN_SCROLL_LEFT);
+    AddSnapshotRegion(SCREEN_SCROLL_RIGHT);
+    AddSnapshotRegion(lastXSize);
+    AddSnapshotRegion(lastYSize);
+    AddSnapshotRegion(pauseEnabled);
+    AddSnapshotRegion(timeEnabled);
+    AddSnapshotRegion(debugMode);
+    AddSnapshotRegion(frameCounter);
+    AddSnapshotRegion(stageMilliseconds);
+    AddSnapshotRegion(stageSeconds);
+    AddSnapshotRegion(stageMinutes);
+    AddSnapshotRegion(Engine.frameCount);
+    AddSnapshotRegion(activeTileLayers);
+    AddSnapshotRegion(tLayerMidPoint);
+    AddSnapshotRegion(bgDeformationData0);
+    AddSnapshotRegion(bgDeformationData1);
+    AddSnapshotRegion(bgDeformationData2);
+    AddSnapshotRegion(bgDeformationData3);
+    AddSnapshotRegion(hParallax);
+    AddSnapshotRegion(vParallax);
+    for (int i = 0; i < LAYER_COUNT; ++i)
+        AddSnapshotRegionPtr(&stageLayouts[i].parallaxFactor, sizeof(TileLayer) - offsetof(TileLayer, parallaxFactor));
+    for (int i = 0; i < 2; ++i)
+        AddSnapshotRegionPtr(collisionMasks[i].angles, sizeof(collisionMasks[i].angles) + sizeof(collisionMasks[i].flags));
+
+    AddSnapshotRegion(objectEntityList);
+    AddSnapshotRegion(OBJECT_BORDER_X1);
+    AddSnapshotRegion(OBJECT_BORDER_X2);
+    AddSnapshotRegion(playerList);
+    AddSnapshotRegion(playerListPos);
+    AddSnapshotRegion(activePlayer);
+    AddSnapshotRegion(activePlayerCount);
+    AddSnapshotRegion(upBuffer);
+    AddSnapshotRegion(downBuffer);
+    AddSnapshotRegion(leftBuffer);
+    AddSnapshotRegion(rightBuffer);
+    AddSnapshotRegion(jumpPressBuffer);
+    AddSnapshotRegion(jumpHoldBuffer);
+    AddSnapshotRegion(scriptEng);
+    AddSnapshotRegion(globalVariables);
+    AddSnapshotRegion(collisionStorage);
+
+    AddSnapshotRegion(fullPalette);
+    AddSnapshotRegion(fullPalette32);
+    AddSnapshotRegion(activePalette);
+    AddSnapshotRegion(activePalette32);
+    AddSnapshotRegion(gfxLineBuffer);
+    AddSnapshotRegion(fadeMode);
+    AddSnapshotRegion(fadeA);
+    AddSnapshotRegion(fadeR);
+    AddSnapshotRegion(fadeG);
+    AddSnapshotRegion(fadeB);
+    AddSnapshotRegion(paletteMode);
+    AddSnapshotRegion(texPaletteNum);
+    AddSnapshotRegion(drawListEntries);
+    AddSnapshotRegion(tileUVArray);
+
+    AddSnapshotRegion(vertexCount);
+    AddSnapshotRegion(faceCount);
+    AddSnapshotRegion(matFinal);
+    AddSnapshotRegion(matWorld);
+    AddSnapshotRegion(matView);
+    AddSnapshotRegion(matTemp);
+    AddSnapshotRegion(faceBuffer);
+    AddSnapshotRegion(vertexBuffer);
+    AddSnapshotRegion(projectionX);
+    AddSnapshotRegion(projectionY);
+
+    AddSnapshotRegion(sfxChannels);
+
+    for (int i = 0; i < LAYER_COUNT; ++i) AddSnapshotDeltaRegion(stageLayouts[i].tiles, sizeof(stageLayouts[i].tiles));
+    AddSnapshotDeltaRegion(&tiles128x128, sizeof(tiles128x128));
+    AddSnapshotDeltaRegion(tilesetGFXData, sizeof(tilesetGFXData));
+}
+
+void CaptureStageBaseline()
+{
+    SetupSnapshotRegions();
+    if (!snapshotBaseline) {
+        snapshotBaseline = (byte *)malloc(snapshotBaselineSize);
+        if (!snapshotBaseline)
+            return;
+    }
+
+    byte *dst = snapshotBaseline;
+    for (int r = 0; r < snapshotDeltaRegionCount; ++r) {
+        memcpy(dst, snapshotDeltaRegions[r].data, snapshotDeltaRegions[r].size);
+        dst += snapshotDeltaRegions[r].size;
+    }
+    ++snapshotStageSerial; // older snapshots belong to a different load of the stage now
+}
+
+bool SaveStageSnapshot(int slot)
+{
+    if (!IsSnapshotSlotValid(slot) || !snapshotBaseline || Engine.gameMode != ENGINE_MAINGAME || stageMode == STAGEMODE_LOAD)
+        return false;
+
+    unsigned long long start = Time_GetPerformanceCounter();
+    StageSnapshot *snapshot  = &stageSnapshots[slot];
+    if (!snapshot->arena) {
+        snapshot->arena = (byte *)malloc(snapshotFlatSize + STAGESNAPSHOT_DELTA_SIZE);
+        if (!snapshot->arena)
+            return false;
+    }
+
+    byte *dst = snapshot->arena;
+    LockAudioDevice();
+    for (int r = 0; r < snapshotRegionCount; ++r) {
+        memcpy(dst, snapshotRegions[r].data, snapshotRegions[r].size);
+        dst += snapshotRegions[r].size;
+    }
+    UnlockAudioDevice();
+
+    byte *deltaStart = dst;
+    byte *deltaEnd   = deltaStart + STAGESNAPSHOT_DELTA_SIZE;
+    byte *base       = snapshotBaseline;
+    for (int r = 0; r < snapshotDeltaRegionCount; ++r) {
+        byte *data = (byte *)snapshotDeltaRegions[r].data;
+        int size   = snapshotDeltaRegions[r].size;
+        for (int pos = 0, c = 0; pos < size; pos += STAGESNAPSHOT_CHUNK_SIZE, ++c) {
+            int len = size - pos < STAGESNAPSHOT_CHUNK_SIZE ? size - pos : STAGESNAPSHOT_CHUNK_SIZE;
+            if (!memcmp(&data[pos], &base[pos], len))
+                continue;
+
+            if (dst + sizeof(uint) + len > deltaEnd) {
+                PrintLog("Snapshot %d: stage changes don't fit in %d bytes", slot, STAGESNAPSHOT_DELTA_SIZE);
+                snapshot->valid = false;
+                return false;
+            }
+            uint key = (r << 16) | c;
+            memcpy(dst, &key, sizeof(uint));
+            memcpy(dst + sizeof(uint), &data[pos], len);
+            dst += sizeof(uint) + len;
+        }
+        base += size;
+    }
+
+    snapshot->deltaSize   = (int)(dst - deltaStart);
+    snapshot->stageSerial = snapshotStageSerial;
+    snapshot->valid       = true;
+    if (slot != STAGESNAPSHOT_VERIFY)
+        PrintLog("Saved snapshot %d: %d bytes + %d bytes of stage changes in %.3fms", slot, snapshotFlatSize, snapshot->deltaSize,
+                 (Time_GetPerformanceCounter() - start) * 1000.0 / Time_GetPerformanceFrequency());
+    return true;
+}
+
+bool LoadStageSnapshot(int slot)
+{
+    if (!IsSnapshotSlotValid(slot) || Engine.gameMode != ENGINE_MAINGAME)
+        return false;
+
+    StageSnapshot *snapshot = &stageSnapshots[slot];
+    if (!snapshot->valid || snapshot->stageSerial != snapshotStageSerial || stageMode == STAGEMODE_LOAD) {
+        PrintLog("Snapshot %d doesn't belong to the loaded stage", slot);
+        return false;
+    }
+
+    unsigned long long start = Time_GetPerformanceCounter();
+    byte *src                = snapshot->arena;
+    LockAudioDevice();
+    for (int r = 0; r < snapshotRegionCount; ++r) {
+        memcpy(snapshotRegions[r].data, src, snapshotRegions[r].size);
+        src += snapshotRegions[r].size;
+    }
+    UnlockAudioDevice();
+
+    // each chunk comes from the snapshot if it was stored, otherwise it goes back to how the stage was loaded
+    byte *deltaEnd = src + snapshot->deltaSize;
+    byte *base     = snapshotBaseline;
+    for (int r = 0; r < snapshotDeltaRegionCount; ++r) {
+        byte *data = (byte *)snapshotDeltaRegions[r].data;
+        int size   = snapshotDeltaRegions[r].size;
+        for (int pos = 0, c = 0; pos < size; pos += STAGESNAPSHOT_CHUNK_SIZE, ++c) {
+            int len     = size - pos < STAGESNAPSHOT_CHUNK_SIZE ? size - pos : STAGESNAPSHOT_CHUNK_SIZE;
+            byte *chunk = &base[pos];
+
+            uint key = 0;
+            if (src < deltaEnd)
+                memcpy(&key, src, sizeof(uint));
+            if (src < deltaEnd && key == (uint)((r << 16) | c)) {
+                chunk = src + sizeof(uint);
+                src += sizeof(uint) + len;
+            }
+
+            if (memcmp(&data[pos], chunk, len))
+                memcpy(&data[pos], chunk, len);
+        }
+        base += size;
+    }
+
+    SyncAllEntityHotFields();
+
+    if (slot != STAGESNAPSHOT_VERIFY)
+        PrintLog("Loaded snapshot %d in %.3fms", slot, (Time_GetPerformanceCounter() - start) * 1000.0 / Time_GetPerformanceFrequency());
+    return true;
+}
+
+void ReleaseStageSnapshots()
+{
+    for (int i = 0; i <= STAGESNAPSHOT_VERIFY; ++i) {
+        if (stageSnapshots[i].arena)
+            free(stageSnapshots[i].arena);
+        stageSnapshots[i].arena = NULL;
+        stageSnapshots[i].valid = false;
+    }
+
+    if (snapshotBaseline)
+        free(snapshotBaseline);
+    snapshotBaseline = NULL;
+}
+
+// Loads every stage's layout, chunks, collision masks and bytecode with streamed cursors and then buffered ones,
+// so both ways are timed on the same files and can be checked against each other
+int BenchmarkLoaders(int iterations)
+{
+    double tickMS      = 1000.0 / Time_GetPerformanceFrequency();
+    int logLevel       = Engine.logLevel;
+    double totals[2]   = { 0.0, 0.0 };
+    int stageCount     = 0;
+    int mismatches     = 0;
+    int scriptCodeBase = scriptCodePos;
+    int jumpTableBase  = jumpTablePos;
+
+    for (int l = 0; l < STAGELIST_MAX; ++l) {
+        for (int s = 0; s < stageListCount[l]; ++s) {
+            activeStageList   = l;
+            stageListPosition = s;
+
+            Engine.logLevel = LOGLEVEL_WARNING; // the per file parse logs would swamp the timings
+
+            // one untimed load first so neither way pays for the files being read from disk for the first time
+            LoadActLayout();
+            LoadStageChunks();
+            LoadStageCollisions();
+            LoadBytecode(l, 1);
+
+            double times[2];
+            uint hashes[2];
+            for (int m = 0; m < 2; ++m) {
+                streamFileCursors = m == 0;
+                MEM_ZERO(stageLayouts[0]);
+                MEM_ZERO(tiles128x128);
+                MEM_ZERO(collisionMasks);
+                MEM_ZERO(titleCardText);
+                MEM_ZERO(objectScriptList);
+                MEM_ZERO(scriptFunctionList);
+                memset(&objectEntityList[32], 0, (TEMPENTITY_START - 32) * sizeof(Entity));
+
+                unsigned long long start = Time_GetPerformanceCounter();
+                for (int i = 0; i < iterations; ++i) {
+                    LoadActLayout();
+                    LoadStageChunks();
+                    LoadStageCollisions();
+                    scriptCodePos = scriptCodeBase;
+                    jumpTablePos  = jumpTableBase;
+                    LoadBytecode(l, 1);
+                }
+                times[m] = (Time_GetPerformanceCounter() - start) * tickMS;
+                totals[m] += times[m];
+
+                // everything the loaders write: the act's tiles, title card and objects, chunks, masks, and the bytecode with its sub pointers
+                uint hash = HashStateBytes(STATEHASH_SEED, &stageLayouts[0], sizeof(TileLayer));
+                hash      = HashStateBytes(hash, titleCardText, sizeof(titleCardText));
+                hash      = HashStateBytes(hash, &titleCardWord2, sizeof(titleCardWord2));
+                hash      = HashStateBytes(hash, activeTileLayers, sizeof(activeTileLayers));
+                hash      = HashStateBytes(hash, &tLayerMidPoint, sizeof(tLayerMidPoint));
+                hash      = HashStateBytes(hash, &objectEntityList[32], (TEMPENTITY_START - 32) * sizeof(Entity));
+                hash      = HashStateBytes(hash, &tiles128x128, sizeof(tiles128x128));
+                hash      = HashStateBytes(hash, collisionMasks, sizeof(collisionMasks));
+                hash      = HashStateBytes(hash, &scriptCode[scriptCodeBase], (scriptCodePos - scriptCodeBase) * sizeof(int));
+                hash      = HashStateBytes(hash, &jumpTable[jumpTableBase], (jumpTablePos - jumpTableBase) * sizeof(int));
+                hash      = HashStateBytes(hash, objectScriptList, sizeof(objectScriptList));
+                hashes[m] = HashStateBytes(hash, scriptFunctionList, sizeof(scriptFunctionList));
+            }
+            Engine.logLevel = logLevel;
+
+            if (hashes[0] != hashes[1]) {
+                PrintLog("ERROR: %s (list %d, stage %d) loads differently when buffered", stageList[l][s].name, l, s);
+                ++mismatches;
+            }
+            PrintLog("Loader benchmark: %s streamed %.3fms, buffered %.3fms", stageList[l][s].name, times[0] / iterations,
+                     times[1] / iterations);
+            ++stageCount;
+        }
+    }
+
+    scriptCodePos     = scriptCodeBase;
+    jumpTablePos      = jumpTableBase;
+    streamFileCursors = false;
+
+    if (stageCount) {
+        PrintLog("Loader benchmark: %d stages x %d runs, streamed %.3fms, buffered %.3fms per stage (%.2fx), %d mismatched", stageCount,
+                 iterations, totals[0] / (stageCount * iterations), totals[1] / (stageCount * iterations),
+                 totals[1] > 0.0 ? totals[0] / totals[1] : 0.0, mismatches);
+    }
+    return mismatches ? 1 : 0;
+}
+#endif
@@ -254,6 +254,20 @@ inline void Copy16x16Tile(ushort dest, ushort src)
 
 void SetLayerDeformation(int selectedDef, int waveLength, int waveType, int deformType, int YPos, int waveSize);
 
+#if !RETRO_USE_ORIGINAL_CODE
+#define STAGESNAPSHOT_COUNT      (4) // user slots
+#define STAGESNAPSHOT_CHUNK_SIZE (0x800)
+#define STAGESNAPSHOT_DELTA_SIZE (0x40000) // per slot room for large buffers that differ from the freshly loaded stage
+#define STAGESNAPSHOT_VERIFY     (STAGESNAPSHOT_COUNT) // rewound every frame by VerifyObjectFrame, kept apart from the user slots
+
+void CaptureStageBaseline();
+bool SaveStageSnapshot(int slot);
+bool LoadStageSnapshot(int slot);
+void ReleaseStageSnapshots();
+
+int BenchmarkLoaders(int iterations);
+#endif
+
 void SetPlayerScreenPosition(Player *player);
 void SetPlayerScreenPositionCDStyle(Player *player);
 void SetPlayerHLockedScreenPosition(Player *player);
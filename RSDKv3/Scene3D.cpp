@@ -14,6 +14,15 @@ Vertex vertexBufferT[VERTEXBUFFER_SIZE];
 
 DrawListEntry3D drawList3D[FACEBUFFER_SIZE];
 
+#if !RETRO_USE_ORIGINAL_CODE
+int sortedFaceCount      = 0;
+int sortedFacesLastFrame = 0;
+
+int vertexScreenX[VERTEXBUFFER_SIZE];
+int vertexScreenY[VERTEXBUFFER_SIZE];
+byte vertexClip[VERTEXBUFFER_SIZE];
+#endif
+
 int projectionX = 136;
 int projectionY = 160;
 
@@ -202,6 +211,27 @@ void MatrixRotateXYZ(Matrix *matrix, int rotationX, int rotationY, int rotationZ
     matrix->values[3][2] = 0;
     matrix->values[3][3] = 0x100;
 }
+#if !RETRO_USE_ORIGINAL_CODE
+// The coefficients are copied to locals so the output stores can't alias them, which keeps the whole
+// matrix in registers and lets the compiler vectorise across vertices. Every term keeps its own >> 8
+static inline void TransformVertexBatch(const Matrix *matrix, const Vertex *src, Vertex *dst, int count)
+{
+    const int m00 = matrix->values[0][0], m01 = matrix->values[0][1], m02 = matrix->values[0][2];
+    const int m10 = matrix->values[1][0], m11 = matrix->values[1][1], m12 = matrix->values[1][2];
+    const int m20 = matrix->values[2][0], m21 = matrix->values[2][1], m22 = matrix->values[2][2];
+    const int m30 = matrix->values[3][0], m31 = matrix->values[3][1], m32 = matrix->values[3][2];
+
+    for (int i = 0; i < count; ++i) {
+        int vx   = src[i].x;
+        int vy   = src[i].y;
+        int vz   = src[i].z;
+        dst[i].x = (vx * m00 >> 8) + (vy * m10 >> 8) + (vz * m20 >> 8) + m30;
+        dst[i].y = (vx * m01 >> 8) + (vy * m11 >> 8) + (vz * m21 >> 8) + m31;
+        dst[i].z = (vx * m02 >> 8) + (vy * m12 >> 8) + (vz * m22 >> 8) + m32;
+    }
+}
+#endif
+
 void TransformVertexBuffer()
 {
     for (int y = 0; y < 4; ++y) {
@@ -214,6 +244,9 @@ void TransformVertexBuffer()
     if (vertexCount <= 0)
         return;
 
+#if !RETRO_USE_ORIGINAL_CODE
+    TransformVertexBatch(&matFinal, vertexBuffer, vertexBufferT, vertexCount);
+#else
     int inVertexID  = 0;
     int outVertexID = 0;
     do {
@@ -226,12 +259,18 @@ void TransformVertexBuffer()
         vert->y = (vx * matFinal.values[0][1] >> 8) + (vy * matFinal.values[1][1] >> 8) + (vz * matFinal.values[2][1] >> 8) + matFinal.values[3][1];
         vert->z = (vx * matFinal.values[0][2] >> 8) + (vy * matFinal.values[1][2] >> 8) + (vz * matFinal.values[2][2] >> 8) + matFinal.values[3][2];
     } while (++outVertexID != vertexCount);
+#endif
 }
 void TransformVerticies(Matrix *matrix, int startIndex, int endIndex)
 {
     if (startIndex > endIndex)
         return;
 
+#if !RETRO_USE_ORIGINAL_CODE
+    // startIndex == endIndex still transforms one vertex, same as the original do-while
+    int count = endIndex > startIndex ? endIndex - startIndex : 1;
+    TransformVertexBatch(matrix, &vertexBuffer[startIndex], &vertexBuffer[startIndex], count);
+#else
     do {
         int vx       = vertexBuffer[startIndex].x;
         int vy       = vertexBuffer[startIndex].y;
@@ -241,6 +280,7 @@ void TransformVerticies(Matrix *matrix, int startIndex, int endIndex)
         vert->y      = (vx * matrix->values[0][1] >> 8) + (vy * matrix->values[1][1] >> 8) + (vz * matrix->values[2][1] >> 8) + matrix->values[3][1];
         vert->z      = (vx * matrix->values[0][2] >> 8) + (vy * matrix->values[1][2] >> 8) + (vz * matrix->values[2][2] >> 8) + matrix->values[3][2];
     } while (++startIndex < endIndex);
+#endif
 }
 void Sort3DDrawList()
 {
@@ -251,6 +291,39 @@ void Sort3DDrawList()
         drawList3D[i].faceID = i;
     }
 
+#if !RETRO_USE_ORIGINAL_CODE
+    sortedFaceCount += faceCount;
+
+    // Stable LSD radix sort, back to front. Flipping every bit but the sign turns
+    // the descending signed depth into an ascending unsigned key, ties keep face order
+    static DrawListEntry3D sortBuffer[FACEBUFFER_SIZE];
+    DrawListEntry3D *src = drawList3D;
+    DrawListEntry3D *dst = sortBuffer;
+    for (int shift = 0; shift < 32; shift += 8) {
+        int counts[0x100];
+        memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < faceCount; ++i) counts[((uint)src[i].depth ^ 0x7FFFFFFF) >> shift & 0xFF]++;
+
+        // every face shares this digit, so the pass wouldn't move anything
+        if (counts[((uint)src[0].depth ^ 0x7FFFFFFF) >> shift & 0xFF] == faceCount)
+            continue;
+
+        int offset = 0;
+        for (int b = 0; b < 0x100; ++b) {
+            int count = counts[b];
+            counts[b] = offset;
+            offset += count;
+        }
+        for (int i = 0; i < faceCount; ++i) dst[counts[((uint)src[i].depth ^ 0x7FFFFFFF) >> shift & 0xFF]++] = src[i];
+
+        DrawListEntry3D *swap = src;
+        src                   = dst;
+        dst                   = swap;
+    }
+
+    if (src != drawList3D)
+        memcpy(drawList3D, src, faceCount * sizeof(DrawListEntry3D));
+#else
     for (int i = 0; i < faceCount; ++i) {
         for (int j = faceCount - 1; j > i; --j) {
             if (drawList3D[j].depth > drawList3D[j - 1].depth) {
@@ -263,9 +336,151 @@ void Sort3DDrawList()
             }
         }
     }
+#endif
+}
+
+#if !RETRO_USE_ORIGINAL_CODE
+void UpdateSortStats()
+{
+    static int frames = 0;
+    static int total  = 0;
+    static int peak   = 0;
+
+    sortedFacesLastFrame = sortedFaceCount;
+    sortedFaceCount      = 0;
+    if (Engine.showSortStats) {
+        total += sortedFacesLastFrame;
+        if (sortedFacesLastFrame > peak)
+            peak = sortedFacesLastFrame;
+        if (++frames >= Engine.refreshRate) {
+            PrintLog("3D sort: %d faces/frame (avg over %d frames), peak %d", total / frames, frames, peak);
+            frames = 0;
+            total  = 0;
+            peak   = 0;
+        }
+    }
 }
+
+// Projects a transformed vertex into the screen cache. The clip codes match the early outs in
+// DrawFace/DrawTexturedFace, widened by a guard band in HW mode so stereo offsets can't pull a culled face back in
+static inline void ProjectVertex(int id, int guard)
+{
+    Vertex *vert = &vertexBufferT[id];
+    if (vert->z <= 0x100) {
+        vertexClip[id] = CLIP_NEAR;
+        return;
+    }
+
+    int x = SCREEN_CENTERX + projectionX * vert->x / vert->z;
+    int y = SCREEN_CENTERY - projectionY * vert->y / vert->z;
+
+    byte clip = 0;
+    if (x < -guard)
+        clip |= CLIP_LEFT;
+    if (x > GFX_LINESIZE + guard)
+        clip |= CLIP_RIGHT;
+    if (y < -guard)
+        clip |= CLIP_TOP;
+    if (y > SCREEN_YSIZE + guard)
+        clip |= CLIP_BOTTOM;
+
+    vertexScreenX[id] = x;
+    vertexScreenY[id] = y;
+    vertexClip[id]    = clip;
+}
+
+// returns false if the face is behind the near plane or entirely off one side of the screen
+static inline bool ProjectFace(Face *face, Vertex *quad, int guard)
+{
+    // faces may still point at vertices past vertexCount, those weren't part of the batch
+    if (face->a >= vertexCount)
+        ProjectVertex(face->a, guard);
+    if (face->b >= vertexCount)
+        ProjectVertex(face->b, guard);
+    if (face->c >= vertexCount)
+        ProjectVertex(face->c, guard);
+    if (face->d >= vertexCount)
+        ProjectVertex(face->d, guard);
+
+    byte clipOr  = vertexClip[face->a] | vertexClip[face->b] | vertexClip[face->c] | vertexClip[face->d];
+    byte clipAnd = vertexClip[face->a] & vertexClip[face->b] & vertexClip[face->c] & vertexClip[face->d];
+    if ((clipOr & CLIP_NEAR) || clipAnd)
+        return false;
+
+    quad[0].x = vertexScreenX[face->a];
+    quad[0].y = vertexScreenY[face->a];
+    quad[1].x = vertexScreenX[face->b];
+    quad[1].y = vertexScreenY[face->b];
+    quad[2].x = vertexScreenX[face->c];
+    quad[2].y = vertexScreenY[face->c];
+    quad[3].x = vertexScreenX[face->d];
+    quad[3].y = vertexScreenY[face->d];
+    return true;
+}
+#endif
+
 void Draw3DScene(int spriteSheetID)
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    int guard = renderType == RENDER_SW ? 0 : 0x20;
+    for (int v = 0; v < vertexCount; ++v) ProjectVertex(v, guard);
+
+    Vertex quad[4];
+    for (int i = 0; i < faceCount; ++i) {
+        Face *face = &faceBuffer[drawList3D[i].faceID];
+        memset(quad, 0, 4 * sizeof(Vertex));
+        switch (face->flags) {
+            default: break;
+            case FACE_FLAG_TEXTURED_3D:
+                if (ProjectFace(face, quad, guard)) {
+                    quad[0].u = vertexBuffer[face->a].u;
+                    quad[0].v = vertexBuffer[face->a].v;
+                    quad[1].u = vertexBuffer[face->b].u;
+                    quad[1].v = vertexBuffer[face->b].v;
+                    quad[2].u = vertexBuffer[face->c].u;
+                    quad[2].v = vertexBuffer[face->c].v;
+                    quad[3].u = vertexBuffer[face->d].u;
+                    quad[3].v = vertexBuffer[face->d].v;
+                    DrawTexturedFace(quad, spriteSheetID);
+                }
+                break;
+            case FACE_FLAG_TEXTURED_2D:
+                quad[0].x = vertexBuffer[face->a].x;
+                quad[0].y = vertexBuffer[face->a].y;
+                quad[1].x = vertexBuffer[face->b].x;
+                quad[1].y = vertexBuffer[face->b].y;
+                quad[2].x = vertexBuffer[face->c].x;
+                quad[2].y = vertexBuffer[face->c].y;
+                quad[3].x = vertexBuffer[face->d].x;
+                quad[3].y = vertexBuffer[face->d].y;
+                quad[0].u = vertexBuffer[face->a].u;
+                quad[0].v = vertexBuffer[face->a].v;
+                quad[1].u = vertexBuffer[face->b].u;
+                quad[1].v = vertexBuffer[face->b].v;
+                quad[2].u = vertexBuffer[face->c].u;
+                quad[2].v = vertexBuffer[face->c].v;
+                quad[3].u = vertexBuffer[face->d].u;
+                quad[3].v = vertexBuffer[face->d].v;
+                DrawTexturedFace(quad, spriteSheetID);
+                break;
+            case FACE_FLAG_COLOURED_3D:
+                if (ProjectFace(face, quad, guard))
+                    DrawFace(quad, face->colour);
+                break;
+            case FACE_FLAG_COLOURED_2D:
+                quad[0].x = vertexBuffer[face->a].x;
+                quad[0].y = vertexBuffer[face->a].y;
+                quad[1].x = vertexBuffer[face->b].x;
+                quad[1].y = vertexBuffer[face->b].y;
+                quad[2].x = vertexBuffer[face->c].x;
+                quad[2].y = vertexBuffer[face->c].y;
+                quad[3].x = vertexBuffer[face->d].x;
+                quad[3].y = vertexBuffer[face->d].y;
+                DrawFace(quad, face->colour);
+                break;
+        }
+    }
+#else
     Vertex quad[4];
     for (int i = 0; i < faceCount; ++i) {
         Face *face = &faceBuffer[drawList3D[i].faceID];
@@ -340,8 +555,140 @@ void Draw3DScene(int spriteSheetID)
                 break;
         }
     }
+#endif
+}
+
+#if !RETRO_USE_ORIGINAL_CODE
+// Faces are scan converted from all six vertex pairs. The A-D edge spans every row of the face, so it seeds the
+// line bounds directly instead of clearing them first. Edges that originally ran before it then win ties so the
+// picked U/V stay the same as the original edge order
+enum ScanEdgeModes {
+    SCANEDGE_SET,
+    SCANEDGE_TIES,
+    SCANEDGE_MERGE,
+};
+
+static inline void ScanEdge(Vertex *vertA, Vertex *vertB, int mode)
+{
+    int bottom, top;
+
+    if (vertA->y == vertB->y)
+        return;
+    if (vertA->y >= vertB->y) {
+        top    = vertB->y;
+        bottom = vertA->y + 1;
+    }
+    else {
+        top    = vertA->y;
+        bottom = vertB->y + 1;
+    }
+    if (top > SCREEN_YSIZE - 1 || bottom < 0)
+        return;
+    if (bottom > SCREEN_YSIZE)
+        bottom = SCREEN_YSIZE;
+    int fullX = vertA->x << 16;
+    int fullY = ((vertB->x - vertA->x) << 16) / (vertB->y - vertA->y);
+    if (top < 0) {
+        fullX -= top * fullY;
+        top = 0;
+    }
+
+    int *lineStart = &faceLineStart[top];
+    int *lineEnd   = &faceLineEnd[top];
+    int *linesEnd  = &faceLineStart[bottom];
+    if (mode == SCANEDGE_SET) {
+        for (; lineStart < linesEnd; ++lineStart, ++lineEnd) {
+            *lineStart = fullX >> 16;
+            *lineEnd   = fullX >> 16;
+            fullX += fullY;
+        }
+    }
+    else {
+        for (; lineStart < linesEnd; ++lineStart, ++lineEnd) {
+            int trueX = fullX >> 16;
+            if (trueX < *lineStart)
+                *lineStart = trueX;
+            if (trueX > *lineEnd)
+                *lineEnd = trueX;
+            fullX += fullY;
+        }
+    }
+}
+
+static inline void ScanEdgeUV(Vertex *vertA, Vertex *vertB, int mode)
+{
+    int bottom, top;
+
+    if (vertA->y == vertB->y)
+        return;
+    if (vertA->y >= vertB->y) {
+        top    = vertB->y;
+        bottom = vertA->y + 1;
+    }
+    else {
+        top    = vertA->y;
+        bottom = vertB->y + 1;
+    }
+    if (top > SCREEN_YSIZE - 1 || bottom < 0)
+        return;
+    if (bottom > SCREEN_YSIZE)
+        bottom = SCREEN_YSIZE;
+
+    int yDifference = vertB->y - vertA->y;
+    int fullX       = vertA->x << 16;
+    int fullU       = vertA->u << 16;
+    int fullV       = vertA->v << 16;
+    int finalX      = ((vertB->x - vertA->x) << 16) / yDifference;
+    int trueU       = vertA->u == vertB->u ? 0 : ((vertB->u - vertA->u) << 16) / yDifference;
+    int trueV       = vertA->v == vertB->v ? 0 : ((vertB->v - vertA->v) << 16) / yDifference;
+    if (top < 0) {
+        fullX -= top * finalX;
+        fullU -= top * trueU;
+        fullV -= top * trueV;
+        top = 0;
+    }
+
+    for (int i = top; i < bottom; ++i) {
+        int trueX = fullX >> 16;
+        if (mode == SCANEDGE_SET || (mode == SCANEDGE_TIES ? trueX <= faceLineStart[i] : trueX < faceLineStart[i])) {
+            faceLineStart[i]  = trueX;
+            faceLineStartU[i] = fullU;
+            faceLineStartV[i] = fullV;
+        }
+        if (mode == SCANEDGE_SET || (mode == SCANEDGE_TIES ? trueX >= faceLineEnd[i] : trueX > faceLineEnd[i])) {
+            faceLineEnd[i]  = trueX;
+            faceLineEndU[i] = fullU;
+            faceLineEndV[i] = fullV;
+        }
+        fullX += finalX;
+        fullU += trueU;
+        fullV += trueV;
+    }
+}
+
+void ProcessScanEdge(Vertex *vertA, Vertex *vertB) { ScanEdge(vertA, vertB, SCANEDGE_MERGE); }
+void ProcessScanEdgeUV(Vertex *vertA, Vertex *vertB) { ScanEdgeUV(vertA, vertB, SCANEDGE_MERGE); }
+
+void ProcessFaceEdges(Vertex *verts, int vertexA, int vertexB, int vertexC, int vertexD)
+{
+    ScanEdge(&verts[vertexA], &verts[vertexD], SCANEDGE_SET);
+    ScanEdge(&verts[vertexA], &verts[vertexB], SCANEDGE_MERGE);
+    ScanEdge(&verts[vertexA], &verts[vertexC], SCANEDGE_MERGE);
+    ScanEdge(&verts[vertexB], &verts[vertexC], SCANEDGE_MERGE);
+    ScanEdge(&verts[vertexC], &verts[vertexD], SCANEDGE_MERGE);
+    ScanEdge(&verts[vertexB], &verts[vertexD], SCANEDGE_MERGE);
 }
 
+void ProcessFaceEdgesUV(Vertex *verts, int vertexA, int vertexB, int vertexC, int vertexD)
+{
+    ScanEdgeUV(&verts[vertexA], &verts[vertexD], SCANEDGE_SET);
+    ScanEdgeUV(&verts[vertexA], &verts[vertexC], SCANEDGE_TIES);
+    ScanEdgeUV(&verts[vertexA], &verts[vertexB], SCANEDGE_TIES);
+    ScanEdgeUV(&verts[vertexB], &verts[vertexC], SCANEDGE_MERGE);
+    ScanEdgeUV(&verts[vertexC], &verts[vertexD], SCANEDGE_MERGE);
+    ScanEdgeUV(&verts[vertexB], &verts[vertexD], SCANEDGE_MERGE);
+}
+#else
 void ProcessScanEdge(Vertex *vertA, Vertex *vertB)
 {
     int bottom, top;
@@ -437,3 +784,4 @@ void ProcessScanEdgeUV(Vertex *vertA, Vertex *vertB)
         fullV += trueV;
     }
 }
+#endif
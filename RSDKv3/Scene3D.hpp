@@ -11,6 +11,14 @@ enum FaceFlags {
     FACE_FLAG_COLOURED_2D = 3,
 };
 
+enum ClipCodes {
+    CLIP_NEAR   = 1 << 0,
+    CLIP_LEFT   = 1 << 1,
+    CLIP_RIGHT  = 1 << 2,
+    CLIP_TOP    = 1 << 3,
+    CLIP_BOTTOM = 1 << 4,
+};
+
 enum MatrixTypes {
     MAT_WORLD = 0,
     MAT_VIEW  = 1,
@@ -57,6 +65,16 @@ extern Vertex vertexBufferT[VERTEXBUFFER_SIZE];
 
 extern DrawListEntry3D drawList3D[FACEBUFFER_SIZE];
 
+#if !RETRO_USE_ORIGINAL_CODE
+extern int sortedFaceCount;      // faces depth sorted so far this frame
+extern int sortedFacesLastFrame; // sortedFaceCount as of the end of the last frame
+
+// screen space cache filled by Draw3DScene, each vertex is projected once per scene
+extern int vertexScreenX[VERTEXBUFFER_SIZE];
+extern int vertexScreenY[VERTEXBUFFER_SIZE];
+extern byte vertexClip[VERTEXBUFFER_SIZE];
+#endif
+
 extern int projectionX;
 extern int projectionY;
 
@@ -78,9 +96,17 @@ void MatrixRotateXYZ(Matrix *matrix, int rotationX, int rotationY, int rotationZ
 void TransformVertexBuffer();
 void TransformVerticies(Matrix *matrix, int startIndex, int endIndex);
 void Sort3DDrawList();
+#if !RETRO_USE_ORIGINAL_CODE
+void UpdateSortStats();
+#endif
 void Draw3DScene(int spriteSheetID);
 
 void ProcessScanEdge(Vertex *vertA, Vertex *vertB);
 void ProcessScanEdgeUV(Vertex *vertA, Vertex *vertB);
+#if !RETRO_USE_ORIGINAL_CODE
+// fills the face line bounds for a quad whose vertices are sorted top to bottom (A-D)
+void ProcessFaceEdges(Vertex *verts, int vertexA, int vertexB, int vertexC, int vertexD);
+void ProcessFaceEdgesUV(Vertex *verts, int vertexA, int vertexB, int vertexC, int vertexD);
+#endif
 
 #endif // !DRAWING3D_H
@@ -1,6 +1,18 @@
 #include "RetroEngine.hpp"
 #include <cmath>
 
+#if !RETRO_USE_ORIGINAL_CODE
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+#include <algorithm>
+#include <cstdarg>
+#include <set>
+#include <string>
+#endif
+
 ObjectScript objectScriptList[OBJECT_COUNT];
 
 ScriptFunction scriptFunctionList[FUNCTION_COUNT];
@@ -21,6 +33,19 @@ int functionStackPos  = 0;
 ScriptEngine scriptEng = ScriptEngine();
 char scriptText[0x100];
 
+#if !RETRO_USE_ORIGINAL_CODE
+NativeScript nativeFunctionList[FUNCTION_COUNT];
+
+struct NativeScriptBinding {
+    int scriptCodePtr;
+    NativeScript script;
+};
+std::vector<NativeScriptBinding> nativeSubBindings; // sorted by scriptCodePtr
+
+enum ScriptStepModes { SCRIPTSTEP_NONE, SCRIPTSTEP_INSTRUCTION, SCRIPTSTEP_OPERANDS };
+int scriptStepMode = SCRIPTSTEP_NONE; // the next ProcessScript call stops after a single instruction
+#endif
+
 
 #define COMMONALIAS_COUNT (0x20)
 #define ALIAS_COUNT       (COMMONALIAS_COUNT + 0x60)
@@ -865,6 +890,86 @@ enum ScrFunction {
 };
 
 #if RETRO_USE_COMPILER
+#if !RETRO_USE_ORIGINAL_CODE
+// Hash indexes over the name tables the compiler searches for every token. Each one indexes ids [0, count) of its table
+// and fills in lazily as the table grows, names are read back from the table itself so renames are always seen
+#define SCRIPTNAMEINDEX_SIZE (0x800)
+
+struct ScriptNameIndex {
+    const char *(*getName)(int id);
+    int count;
+    ushort slots[SCRIPTNAMEINDEX_SIZE]; // id + 1, 0 is an empty slot
+    uint hashes[SCRIPTNAMEINDEX_SIZE];
+};
+
+const char *GetOpcodeName(int id) { return functions[id].name; }
+const char *GetVariableName(int id) { return variableNames[id]; }
+const char *GetAliasName(int id) { return aliases[id].name; }
+const char *GetGlobalVariableName(int id) { return globalVariableNames[id]; }
+const char *GetScriptFunctionName(int id) { return scriptFunctionList[id].name; }
+const char *GetTypeName(int id) { return typeNames[id]; }
+
+ScriptNameIndex opcodeIndex         = { GetOpcodeName, 0, {}, {} };
+ScriptNameIndex variableIndex       = { GetVariableName, 0, {}, {} };
+ScriptNameIndex aliasIndex          = { GetAliasName, 0, {}, {} };
+ScriptNameIndex globalVariableIndex = { GetGlobalVariableName, 0, {}, {} };
+ScriptNameIndex scriptFunctionIndex = { GetScriptFunctionName, 0, {}, {} };
+ScriptNameIndex typeNameIndex       = { GetTypeName, 0, {}, {} };
+
+int scriptCompileLookups = 0;
+
+void ClearScriptNameIndex(ScriptNameIndex *index)
+{
+    memset(index->slots, 0, sizeof(index->slots));
+    index->count = 0;
+}
+
+void InvalidateTypeNameIndex() { ClearScriptNameIndex(&typeNameIndex); }
+
+// Returns the lowest id above 'after' whose name matches, or the highest if 'last' is set. -1 if there's none
+int FindScriptName(ScriptNameIndex *index, int count, const char *name, int after, bool last)
+{
+    ++scriptCompileLookups;
+    int found = -1;
+
+    // empty names aren't indexed since unused slots would all pile up in the same place
+    if (!name[0]) {
+        for (int id = after + 1; id < count; ++id) {
+            if (StrComp(name, index->getName(id))) {
+                found = id;
+                if (!last)
+                    break;
+            }
+        }
+        return found;
+    }
+
+    if (index->count > count)
+        ClearScriptNameIndex(index);
+    for (; index->count < count; ++index->count) {
+        const char *entryName = index->getName(index->count);
+        if (!entryName[0])
+            continue;
+
+        uint hash = HashStringNoCase(entryName);
+        int pos   = hash & (SCRIPTNAMEINDEX_SIZE - 1);
+        while (index->slots[pos]) pos = (pos + 1) & (SCRIPTNAMEINDEX_SIZE - 1);
+        index->slots[pos]  = index->count + 1;
+        index->hashes[pos] = hash;
+    }
+
+    uint hash = HashStringNoCase(name);
+    for (int pos = hash & (SCRIPTNAMEINDEX_SIZE - 1); index->slots[pos]; pos = (pos + 1) & (SCRIPTNAMEINDEX_SIZE - 1)) {
+        int id = index->slots[pos] - 1;
+        if (index->hashes[pos] != hash || id <= after || (found != -1 && (last ? id < found : id > found)))
+            continue;
+        if (StrComp(name, index->getName(id)))
+            found = id;
+    }
+    return found;
+}
+#endif
+
 void CheckAliasText(char *text)
 {
     if (FindStringToken(text, "#alias", 1) != 0)
@@ -1052,6 +1157,14 @@ void ConvertFunctionText(char *text)
     int namePos    = 0;
     for (namePos = 0; text[namePos] != '(' && text[namePos]; ++namePos) funcName[namePos] = text[namePos];
     funcName[namePos] = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    int opcodeID = FindScriptName(&opcodeIndex, FUNC_MAX_CNT, funcName, -1, false);
+    if (opcodeID > -1) {
+        opcode     = opcodeID;
+        opcodeSize = functions[opcodeID].opcodeSize;
+        textPos    = StrLength(functions[opcodeID].name);
+    }
+#else
     for (int i = 0; i < FUNC_MAX_CNT; ++i) {
         if (StrComp(funcName, functions[i].name)) {
             opcode     = i;
@@ -1060,6 +1173,7 @@ void ConvertFunctionText(char *text)
             i          = FUNC_MAX_CNT;
         }
     }
+#endif
 
     if (opcode <= 0) {
         SetupTextMenu(&gameMenu[0], 0);
@@ -1135,6 +1249,44 @@ void ConvertFunctionText(char *text)
             funcName[varNamePos]   = 0;
             arrayStr[arrayStrPos] = 0;
 
+#if !RETRO_USE_ORIGINAL_CODE
+            // each match renames the token, so keep searching from there with the new name, like the original scans did
+
+            // Eg: TempValue0 = FX_SCALE
+            for (int a = FindScriptName(&aliasIndex, aliasCount, funcName, -1, false); a > -1;
+                 a     = FindScriptName(&aliasIndex, aliasCount, funcName, a, false)) {
+                CopyAliasStr(funcName, aliases[a].value, 0);
+                if (FindStringToken(aliases[a].value, "[", 1) > -1)
+                    CopyAliasStr(arrayStr, aliases[a].value, 1);
+            }
+
+            // Eg: TempValue0 = Game.Variable
+            for (int v = FindScriptName(&globalVariableIndex, globalVariablesCount, funcName, -1, false); v > -1;
+                 v     = FindScriptName(&globalVariableIndex, globalVariablesCount, funcName, v, false)) {
+                StrCopy(funcName, "Global");
+                arrayStr[0] = 0;
+                AppendIntegerToString(arrayStr, v);
+            }
+
+            // Eg: TempValue0 = Function1
+            for (int f = FindScriptName(&scriptFunctionIndex, scriptFunctionCount, funcName, -1, false); f > -1;
+                 f     = FindScriptName(&scriptFunctionIndex, scriptFunctionCount, funcName, f, false)) {
+                funcName[0] = 0;
+                AppendIntegerToString(funcName, f);
+            }
+
+            // Eg: TempValue0 = TypeName[PlayerObject]
+            if (StrComp(funcName, "TypeName")) {
+                funcName[0] = '0';
+                funcName[1] = 0;
+
+                int o = FindScriptName(&typeNameIndex, OBJECT_COUNT, arrayStr, -1, true);
+                if (o > -1) {
+                    funcName[0] = 0;
+                    AppendIntegerToString(funcName, o);
+                }
+            }
+#else
             // Eg: TempValue0 = FX_SCALE
             for (int a = 0; a < aliasCount; ++a) {
                 if (StrComp(funcName, aliases[a].name)) {
@@ -1173,6 +1325,7 @@ void ConvertFunctionText(char *text)
                     }
                 }
             }
+#endif
 
 #if RETRO_USE_MOD_LOADER
             // Eg: TempValue0 = SfxName[Jump]
@@ -1360,11 +1513,15 @@ void ConvertFunctionText(char *text)
                     scriptCode[scriptCodePos++] = VARARR_NONE;
                 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+                constant = FindScriptName(&variableIndex, VAR_MAX_CNT, funcName, -1, true);
+#else
                 constant = -1;
                 for (int i = 0; i < VAR_MAX_CNT; ++i) {
                     if (StrComp(funcName, variableNames[i]))
                         constant = i;
                 }
+#endif
 
                 if (constant == -1 && Engine.gameMode != ENGINE_SCRIPTERROR) {
                     SetupTextMenu(&gameMenu[0], 0);
@@ -1403,12 +1560,18 @@ void CheckCaseNumber(char *text)
     }
     caseString[caseStrPos] = 0;
 
+#if !RETRO_USE_ORIGINAL_CODE
+    int aliasID = FindScriptName(&aliasIndex, aliasCount, caseString, -1, false);
+    if (aliasID > -1)
+        StrCopy(caseString, aliases[aliasID].value);
+#else
     for (int a = 0; a < aliasCount; ++a) {
         if (StrComp(aliases[a].name, caseString)) {
             StrCopy(caseString, aliases[a].value);
             break;
         }
     }
+#endif
 
     int caseID = 0;
     if (ConvertStringToInteger(caseString, &caseID)) {
@@ -1432,10 +1595,16 @@ bool ReadSwitchCase(char *text)
             ++textPos;
         }
         caseText[caseStringPos] = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+        for (int a = FindScriptName(&aliasIndex, aliasCount, caseText, -1, false); a > -1;
+             a     = FindScriptName(&aliasIndex, aliasCount, caseText, a, false))
+            StrCopy(caseText, aliases[a].value);
+#else
         for (int a = 0; a < aliasCount; ++a) {
             if (StrComp(caseText, aliases[a].name))
                 StrCopy(caseText, aliases[a].value);
         }
+#endif
 
         int val = 0;
 
@@ -1566,6 +1735,26 @@ bool ConvertStringToInteger(char *text, int *value)
     return true;
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+inline unsigned long long HashScriptCacheBytes(unsigned long long hash, const void *data, int size)
+{
+    const byte *bytes = (const byte *)data;
+    for (int i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+    return hash;
+}
+
+inline ScriptPtr *GetScriptSubPtr(ObjectScript *script, int sub)
+{
+    switch (sub) {
+        default:
+        case SUB_MAIN: return &script->subMain;
+        case SUB_PLAYERINTERACTION: return &script->subPlayerInteraction;
+        case SUB_DRAW: return &script->subDraw;
+        case SUB_SETUP: return &script->subStartup;
+    }
+}
+#endif
+
 #if RETRO_USE_COMPILER
 void CopyAliasStr(char *dest, char *text, bool arrayIndex)
 {
@@ -1619,8 +1808,299 @@ bool CheckOpcodeType(char *text)
     return true;
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+// Compiled scripts are cached by a hash of everything the compiler reads: the source, the names it can resolve tokens to
+// and the engine build. Code and jump table entries are stored relative to where the file started so they can be
+// restored anywhere in the buffers
+#define SCRIPTCACHE_SIGNATURE (0x43435352) // "RSCC"
+#define SCRIPTCACHE_VERSION   (1)
+#define SCRIPTCACHE_PATH      BASE_PATH "ScriptCache/"
+
+struct ScriptCacheState {
+    char path[0x100];
+    unsigned long long key;
+    int codeStart;
+    int jumpStart;
+    int functionCount;
+    ScriptPtr subs[4];
+    std::vector<byte> cached;
+    bool valid;
+};
+
+ScriptFunction scriptCacheFunctions[FUNCTION_COUNT]; // function list as it was before the file was compiled
+
+inline unsigned long long HashScriptCacheString(unsigned long long hash, const char *string)
+{
+    return HashScriptCacheBytes(hash, string, StrLength(string) + 1);
+}
+
+inline void WriteScriptCacheInt(std::vector<byte> &blob, int value) { blob.insert(blob.end(), (byte *)&value, (byte *)&value + sizeof(int)); }
+
+struct ScriptCacheReader {
+    const byte *data;
+    int size;
+    int pos;
+
+    bool Read(void *dest, int count)
+    {
+        if (count < 0 || pos + count > size)
+            return false;
+        memcpy(dest, data + pos, count);
+        pos += count;
+        return true;
+    }
+    bool ReadInt(int *value) { return Read(value, sizeof(int)); }
+};
+
+bool BeginScriptCache(const char *scriptPath, int scriptID, ScriptCacheState *state)
+{
+    state->valid = false;
+    state->cached.clear();
+    if (!Engine.useScriptCache || Engine.gameMode == ENGINE_SCRIPTERROR)
+        return false;
+
+    FileInfo info;
+    if (!LoadFile(scriptPath, &info))
+        return false;
+    std::vector<byte> source(info.fileSize);
+    FileRead(source.data(), info.fileSize);
+    CloseFile();
+
+    unsigned long long key = 0xCBF29CE484222325ULL;
+    int version            = SCRIPTCACHE_VERSION;
+    key                    = HashScriptCacheBytes(key, &version, sizeof(int));
+    key                    = HashScriptCacheString(key, __DATE__ " " __TIME__);
+    key                    = HashScriptCacheBytes(key, source.data(), (int)source.size());
+
+    key = HashScriptCacheString(key, Engine.gamePlatform);
+    key = HashScriptCacheString(key, Engine.gameRenderType);
+#if RETRO_USE_HAPTICS
+    key = HashScriptCacheString(key, Engine.gameHapticSetting);
+#endif
+    key = HashScriptCacheString(key, Engine.releaseType);
+
+    key = HashScriptCacheBytes(key, &scriptFunctionCount, sizeof(int));
+    for (int f = 0; f < scriptFunctionCount; ++f) key = HashScriptCacheString(key, scriptFunctionList[f].name);
+    key = HashScriptCacheBytes(key, &globalVariablesCount, sizeof(int));
+    for (int v = 0; v < globalVariablesCount; ++v) key = HashScriptCacheString(key, globalVariableNames[v]);
+    for (int o = 0; o < OBJECT_COUNT; ++o) key = HashScriptCacheString(key, typeNames[o]);
+#if RETRO_USE_MOD_LOADER
+    for (int s = 0; s < globalSFXCount; ++s) key = HashScriptCacheString(key, globalSfxNames[s]);
+    key = HashScriptCacheBytes(key, &globalSFXCount, sizeof(int));
+    for (int s = 0; s < stageSFXCount; ++s) key = HashScriptCacheString(key, stageSfxNames[s]);
+    key = HashScriptCacheBytes(key, &stageSFXCount, sizeof(int));
+    for (int a = 0; a < ACHIEVEMENT_COUNT; ++a) key = HashScriptCacheString(key, achievements[a].name);
+    for (int p = 0; p < PLAYERNAME_COUNT; ++p) key = HashScriptCacheString(key, playerNames[p]);
+    for (int l = 0; l < STAGELIST_MAX; ++l) {
+        key = HashScriptCacheBytes(key, &stageListCount[l], sizeof(int));
+        for (int s = 0; s < stageListCount[l]; ++s) key = HashScriptCacheString(key, stageList[l][s].name);
+    }
+#endif
+
+    state->key           = key;
+    state->codeStart     = scriptCodePos;
+    state->jumpStart     = jumpTablePos;
+    state->functionCount = scriptFunctionCount;
+    sprintf(state->path, SCRIPTCACHE_PATH "%08X%08X.bin", (uint)(key >> 32), (uint)key);
+    for (int s = 0; s < 4; ++s) state->subs[s] = *GetScriptSubPtr(&objectScriptList[scriptID], s);
+    memcpy(scriptCacheFunctions, scriptFunctionList, sizeof(scriptFunctionList));
+    state->valid = true;
+
+    FileIO *file = fOpen(state->path, "rb");
+    if (!file)
+        return false;
+    fSeek(file, 0, SEEK_END);
+    int size = (int)fTell(file);
+    fSeek(file, 0, SEEK_SET);
+    if (size > 0) {
+        state->cached.resize(size);
+        if ((int)fRead(state->cached.data(), 1, size, file) != size)
+            state->cached.clear();
+    }
+    fClose(file);
+    return !state->cached.empty();
+}
+
+void BuildScriptCache(ScriptCacheState *state, int scriptID, std::vector<byte> &blob)
+{
+    blob.clear();
+    WriteScriptCacheInt(blob, SCRIPTCACHE_SIGNATURE);
+    WriteScriptCacheInt(blob, SCRIPTCACHE_VERSION);
+    WriteScriptCacheInt(blob, (int)(state->key >> 32));
+    WriteScriptCacheInt(blob, (int)state->key);
+
+    int codeSize = scriptCodePos - state->codeStart;
+    int jumpSize = jumpTablePos - state->jumpStart;
+    WriteScriptCacheInt(blob, codeSize);
+    WriteScriptCacheInt(blob, jumpSize);
+
+    for (int s = 0; s < 4; ++s) {
+        ScriptPtr *ptr = GetScriptSubPtr(&objectScriptList[scriptID], s);
+        bool changed   = ptr->scriptCodePtr != state->subs[s].scriptCodePtr || ptr->jumpTablePtr != state->subs[s].jumpTablePtr;
+        WriteScriptCacheInt(blob, changed);
+        WriteScriptCacheInt(blob, ptr->scriptCodePtr - state->codeStart);
+        WriteScriptCacheInt(blob, ptr->jumpTablePtr - state->jumpStart);
+    }
+
+    // only the functions this file declared or redefined are stored
+    int touchedCount = 0;
+    int touchedPos   = (int)blob.size();
+    WriteScriptCacheInt(blob, scriptFunctionCount);
+    WriteScriptCacheInt(blob, touchedCount);
+    for (int f = 0; f < scriptFunctionCount; ++f) {
+        ScriptFunction *func = &scriptFunctionList[f];
+        ScriptFunction *prev = &scriptCacheFunctions[f];
+        bool ptrChanged      = func->ptr.scriptCodePtr != prev->ptr.scriptCodePtr || func->ptr.jumpTablePtr != prev->ptr.jumpTablePtr;
+        if (f < state->functionCount && !ptrChanged && memcmp(func->name, prev->name, sizeof(func->name)) == 0)
+            continue;
+
+        WriteScriptCacheInt(blob, f);
+        blob.insert(blob.end(), (byte *)func->name, (byte *)func->name + sizeof(func->name));
+        WriteScriptCacheInt(blob, ptrChanged);
+        WriteScriptCacheInt(blob, func->ptr.scriptCodePtr - state->codeStart);
+        WriteScriptCacheInt(blob, func->ptr.jumpTablePtr - state->jumpStart);
+        ++touchedCount;
+    }
+    memcpy(&blob[touchedPos + sizeof(int)], &touchedCount, sizeof(int));
+
+    blob.insert(blob.end(), (byte *)&scriptCode[state->codeStart], (byte *)&scriptCode[scriptCodePos]);
+    blob.insert(blob.end(), (byte *)&jumpTable[state->jumpStart], (byte *)&jumpTable[jumpTablePos]);
+}
+
+bool ApplyScriptCache(ScriptCacheState *state, int scriptID)
+{
+    ScriptCacheReader reader = { state->cached.data(), (int)state->cached.size(), 0 };
+
+    int header[4];
+    if (!reader.Read(header, sizeof(header)) || header[0] != SCRIPTCACHE_SIGNATURE || header[1] != SCRIPTCACHE_VERSION
+        || (uint)header[2] != (uint)(state->key >> 32) || (uint)header[3] != (uint)state->key)
+        return false;
+
+    int codeSize = 0, jumpSize = 0;
+    if (!reader.ReadInt(&codeSize) || !reader.ReadInt(&jumpSize) || codeSize < 0 || jumpSize < 0
+        || scriptCodePos + codeSize > SCRIPTDATA_COUNT || jumpTablePos + jumpSize > JUMPTABLE_COUNT)
+        return false;
+
+    int subs[4][3];
+    if (!reader.Read(subs, sizeof(subs)))
+        return false;
+
+    int functionCount = 0, touchedCount = 0;
+    if (!reader.ReadInt(&functionCount) || !reader.ReadInt(&touchedCount) || functionCount < scriptFunctionCount
+        || functionCount > FUNCTION_COUNT)
+        return false;
+
+    // everything is validated before the script state is touched, so a bad entry just falls back to compiling
+    int functionsPos = reader.pos;
+    for (int t = 0; t < touchedCount; ++t) {
+        int id = -1;
+        char name[0x20];
+        int ptr[3];
+        if (!reader.ReadInt(&id) || !reader.Read(name, sizeof(name)) || !reader.Read(ptr, sizeof(ptr)) || id < 0 || id >= functionCount)
+            return false;
+    }
+    if (reader.pos + (codeSize + jumpSize) * (int)sizeof(int) != reader.size)
+        return false;
+
+    reader.pos = functionsPos;
+    for (int t = 0; t < touchedCount; ++t) {
+        int id = 0;
+        int ptr[3];
+        reader.ReadInt(&id);
+        ScriptFunction *func = &scriptFunctionList[id];
+        reader.Read(func->name, sizeof(func->name));
+        reader.Read(ptr, sizeof(ptr));
+        if (ptr[0]) {
+            func->ptr.scriptCodePtr = ptr[1] + scriptCodePos;
+            func->ptr.jumpTablePtr  = ptr[2] + jumpTablePos;
+        }
+    }
+    scriptFunctionCount = functionCount;
+
+    for (int s = 0; s < 4; ++s) {
+        if (subs[s][0]) {
+            ScriptPtr *ptr     = GetScriptSubPtr(&objectScriptList[scriptID], s);
+            ptr->scriptCodePtr = subs[s][1] + scriptCodePos;
+            ptr->jumpTablePtr  = subs[s][2] + jumpTablePos;
+        }
+    }
+    objectScriptList[scriptID].mobile = true;
+
+    reader.Read(&scriptCode[scriptCodePos], codeSize * sizeof(int));
+    reader.Read(&jumpTable[jumpTablePos], jumpSize * sizeof(int));
+    scriptCodePos += codeSize;
+    jumpTablePos += jumpSize;
+    return true;
+}
+
+// Rewinds the script state to before the file was compiled, applies the cached entry and checks it lands exactly where the
+// fresh compile did. On a mismatch the fresh compile is put back
+bool VerifyScriptCache(ScriptCacheState *state, int scriptID)
+{
+    static ScriptFunction functions[FUNCTION_COUNT];
+    static std::vector<int> code;
+    static std::vector<int> jumps;
+
+    int codeEnd       = scriptCodePos;
+    int jumpEnd       = jumpTablePos;
+    int functionCount = scriptFunctionCount;
+    code.assign(&scriptCode[state->codeStart], &scriptCode[codeEnd]);
+    jumps.assign(&jumpTable[state->jumpStart], &jumpTable[jumpEnd]);
+    memcpy(functions, scriptFunctionList, sizeof(scriptFunctionList));
+    ScriptPtr subs[4];
+    for (int s = 0; s < 4; ++s) subs[s] = *GetScriptSubPtr(&objectScriptList[scriptID], s);
+
+    scriptCodePos       = state->codeStart;
+    jumpTablePos        = state->jumpStart;
+    scriptFunctionCount = state->functionCount;
+    memcpy(scriptFunctionList, scriptCacheFunctions, sizeof(scriptFunctionList));
+    for (int s = 0; s < 4; ++s) *GetScriptSubPtr(&objectScriptList[scriptID], s) = state->subs[s];
+
+    bool match = ApplyScriptCache(state, scriptID) && scriptCodePos == codeEnd && jumpTablePos == jumpEnd && scriptFunctionCount == functionCount;
+    match      = match && (code.empty() || !memcmp(&scriptCode[state->codeStart], code.data(), code.size() * sizeof(int)));
+    match      = match && (jumps.empty() || !memcmp(&jumpTable[state->jumpStart], jumps.data(), jumps.size() * sizeof(int)));
+    match      = match && !memcmp(scriptFunctionList, functions, sizeof(functions));
+    for (int s = 0; s < 4 && match; ++s) {
+        ScriptPtr *ptr = GetScriptSubPtr(&objectScriptList[scriptID], s);
+        match          = ptr->scriptCodePtr == subs[s].scriptCodePtr && ptr->jumpTablePtr == subs[s].jumpTablePtr;
+    }
+
+    if (!match) {
+        if (!code.empty())
+            memcpy(&scriptCode[state->codeStart], code.data(), code.size() * sizeof(int));
+        if (!jumps.empty())
+            memcpy(&jumpTable[state->jumpStart], jumps.data(), jumps.size() * sizeof(int));
+        memcpy(scriptFunctionList, functions, sizeof(functions));
+        for (int s = 0; s < 4; ++s) *GetScriptSubPtr(&objectScriptList[scriptID], s) = subs[s];
+        scriptCodePos       = codeEnd;
+        jumpTablePos        = jumpEnd;
+        scriptFunctionCount = functionCount;
+    }
+    return match;
+}
+
+void SaveScriptCache(ScriptCacheState *state, const std::vector<byte> &blob)
+{
+    static bool madeCacheDir = false;
+    if (!madeCacheDir) {
+#if defined(_WIN32)
+        _mkdir(SCRIPTCACHE_PATH);
+#else
+        mkdir(SCRIPTCACHE_PATH, 0777);
+#endif
+        madeCacheDir = true;
+    }
+    QueueSaveWrite(state->path, blob.data(), (int)blob.size());
+}
+#endif
+
 void ParseScriptFile(char *scriptName, int scriptID)
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    unsigned long long compileStart = Time_GetPerformanceCounter();
+    scriptCompileLookups            = 0;
+    ClearScriptNameIndex(&aliasIndex);
+#endif
 
     jumpTableStackPos = 0;
     lineID            = 0;
@@ -1633,6 +2113,20 @@ void ParseScriptFile(char *scriptName, int scriptID)
     char scriptPath[0x40];
     StrCopy(scriptPath, "Data/Scripts/");
     StrAdd(scriptPath, scriptName);
+
+#if !RETRO_USE_ORIGINAL_CODE
+    static ScriptCacheState cacheState;
+    bool cacheHit = BeginScriptCache(scriptPath, scriptID, &cacheState);
+    if (cacheHit && !Engine.verifyScriptCache) {
+        if (ApplyScriptCache(&cacheState, scriptID)) {
+            PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_DEBUG, "Loaded %s from the script cache: %.3fms", scriptName,
+                             ((Time_GetPerformanceCounter() - compileStart) * 1000.0) / Time_GetPerformanceFrequency());
+            return;
+        }
+        cacheHit = false;
+    }
+#endif
+
     FileInfo info;
     if (LoadFile(scriptPath, &info)) {
         objectScriptList[scriptID].mobile = true; // all parsed scripts will use the updated format, old format support is purely for pc bytecode
@@ -1730,11 +2224,15 @@ void ParseScriptFile(char *scriptName, int scriptID)
                         for (textPos = 8; scriptText[textPos]; ++textPos) funcName[textPos - 8] = scriptText[textPos];
                         funcName[textPos - 8] = 0;
 
+#if !RETRO_USE_ORIGINAL_CODE
+                        int funcID = FindScriptName(&scriptFunctionIndex, scriptFunctionCount, funcName, -1, true);
+#else
                         int funcID = -1;
                         for (int f = 0; f < scriptFunctionCount; ++f) {
                             if (StrComp(funcName, scriptFunctionList[f].name))
                                 funcID = f;
                         }
+#endif
 
                         if (funcID <= -1) {
                             if (scriptFunctionCount >= FUNCTION_COUNT) {
@@ -1764,11 +2262,15 @@ void ParseScriptFile(char *scriptName, int scriptID)
                         for (textPos = 9; scriptText[textPos]; ++textPos) funcName[textPos - 9] = scriptText[textPos];
                         funcName[textPos - 9] = 0;
 
+#if !RETRO_USE_ORIGINAL_CODE
+                        int funcID = FindScriptName(&scriptFunctionIndex, scriptFunctionCount, funcName, -1, true);
+#else
                         int funcID = -1;
                         for (int f = 0; f < scriptFunctionCount; ++f) {
                             if (StrComp(funcName, scriptFunctionList[f].name))
                                 funcID = f;
                         }
+#endif
 
                         if (scriptFunctionCount < FUNCTION_COUNT && funcID == -1) {
                             StrCopy(scriptFunctionList[scriptFunctionCount++].name, funcName);
@@ -1864,6 +2366,29 @@ void ParseScriptFile(char *scriptName, int scriptID)
 
         CloseFile();
     }
+
+#if !RETRO_USE_ORIGINAL_CODE
+    PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_DEBUG, "Compiled %s: %d lines, %d lookups, %.3fms", scriptName, lineID, scriptCompileLookups,
+                     ((Time_GetPerformanceCounter() - compileStart) * 1000.0) / Time_GetPerformanceFrequency());
+
+    if (cacheState.valid && Engine.gameMode != ENGINE_SCRIPTERROR) {
+        static std::vector<byte> blob;
+        BuildScriptCache(&cacheState, scriptID, blob);
+        if (cacheHit) {
+            // loading the cached entry has to reproduce the fresh compile exactly, and the entry has to match what would be written now
+            if (VerifyScriptCache(&cacheState, scriptID) && blob == cacheState.cached) {
+                PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_DEBUG, "Script cache verified for %s", scriptName);
+            }
+            else {
+                PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_WARNING, "WARNING: Script cache mismatch for %s, rewriting %s", scriptName, cacheState.path);
+                SaveScriptCache(&cacheState, blob);
+            }
+        }
+        else {
+            SaveScriptCache(&cacheState, blob);
+        }
+    }
+#endif
 }
 
 #endif
@@ -1900,6 +2425,73 @@ void LoadBytecode(int stageListID, int scriptID)
     }
 
     FileInfo info;
+#if !RETRO_USE_ORIGINAL_CODE
+    if (LoadFile(scriptPath, &info)) {
+        FileCursor cursor;
+        OpenFileCursor(&cursor);
+
+        int *scriptCodePtr = &scriptCode[scriptCodePos];
+        int *jumpTablePtr  = &jumpTable[jumpTablePos];
+
+        int scriptCodeSize = CursorReadU32LE(&cursor);
+        while (scriptCodeSize > 0 && !cursor.overrun) {
+            byte blockHeader = CursorReadByte(&cursor);
+            int blockSize    = blockHeader & 0x7F;
+
+            if (blockHeader >= 0x80) {
+                for (int i = 0; i < blockSize; ++i) scriptCodePtr[i] = CursorReadU32LE(&cursor);
+            }
+            else {
+                for (int i = 0; i < blockSize; ++i) scriptCodePtr[i] = CursorReadByte(&cursor);
+            }
+            scriptCodePtr += blockSize;
+            scriptCodePos += blockSize;
+            scriptCodeSize -= blockSize;
+        }
+
+        int jumpTableSize = CursorReadU32LE(&cursor);
+        while (jumpTableSize > 0 && !cursor.overrun) {
+            byte blockHeader = CursorReadByte(&cursor);
+            int blockSize    = blockHeader & 0x7F;
+
+            if (blockHeader >= 0x80) {
+                for (int i = 0; i < blockSize; ++i) jumpTablePtr[i] = CursorReadU32LE(&cursor);
+            }
+            else {
+                for (int i = 0; i < blockSize; ++i) jumpTablePtr[i] = CursorReadByte(&cursor);
+            }
+            jumpTablePtr += blockSize;
+            jumpTablePos += blockSize;
+            jumpTableSize -= blockSize;
+        }
+
+        int scriptCount = CursorReadU16LE(&cursor);
+        for (int s = 0; s < scriptCount; ++s) {
+            ObjectScript *script = &objectScriptList[scriptID + s];
+
+            script->mobile                             = Engine.bytecodeMode == BYTECODE_MOBILE;
+            script->subMain.scriptCodePtr              = CursorReadU32LE(&cursor);
+            script->subPlayerInteraction.scriptCodePtr = CursorReadU32LE(&cursor);
+            script->subDraw.scriptCodePtr              = CursorReadU32LE(&cursor);
+            script->subStartup.scriptCodePtr           = CursorReadU32LE(&cursor);
+        }
+
+        for (int s = 0; s < scriptCount; ++s) {
+            ObjectScript *script = &objectScriptList[scriptID + s];
+
+            script->subMain.jumpTablePtr              = CursorReadU32LE(&cursor);
+            script->subPlayerInteraction.jumpTablePtr = CursorReadU32LE(&cursor);
+            script->subDraw.jumpTablePtr              = CursorReadU32LE(&cursor);
+            script->subStartup.jumpTablePtr           = CursorReadU32LE(&cursor);
+        }
+
+        int functionCount = CursorReadU16LE(&cursor);
+        for (int f = 0; f < functionCount; ++f) scriptFunctionList[f].ptr.scriptCodePtr = CursorReadU32LE(&cursor);
+        for (int f = 0; f < functionCount; ++f) scriptFunctionList[f].ptr.jumpTablePtr = CursorReadU32LE(&cursor);
+
+        CloseFileCursor(&cursor);
+    }
+#else
     if (LoadFile(scriptPath, &info)) {
         byte fileBuffer = 0;
         int *scriptCodePtr = &scriptCode[scriptCodePos];
@@ -2028,157 +2620,1553 @@ void LoadBytecode(int stageListID, int scriptID)
             FileRead(&fileBuffer, 1);
             script->subDraw.scriptCodePtr |= fileBuffer << 24;
 
-            FileRead(&fileBuffer, 1);
-            script->subStartup.scriptCodePtr = fileBuffer;
-            FileRead(&fileBuffer, 1);
-            script->subStartup.scriptCodePtr |= fileBuffer << 8;
-            FileRead(&fileBuffer, 1);
-            script->subStartup.scriptCodePtr |= fileBuffer << 16;
-            FileRead(&fileBuffer, 1);
-            script->subStartup.scriptCodePtr |= fileBuffer << 24;
-        }
+            FileRead(&fileBuffer, 1);
+            script->subStartup.scriptCodePtr = fileBuffer;
+            FileRead(&fileBuffer, 1);
+            script->subStartup.scriptCodePtr |= fileBuffer << 8;
+            FileRead(&fileBuffer, 1);
+            script->subStartup.scriptCodePtr |= fileBuffer << 16;
+            FileRead(&fileBuffer, 1);
+            script->subStartup.scriptCodePtr |= fileBuffer << 24;
+        }
+
+        for (int s = 0; s < scriptCount; ++s) {
+            ObjectScript *script = &objectScriptList[scriptID + s];
+
+            FileRead(&fileBuffer, 1);
+            script->subMain.jumpTablePtr = fileBuffer;
+            FileRead(&fileBuffer, 1);
+            script->subMain.jumpTablePtr |= fileBuffer << 8;
+            FileRead(&fileBuffer, 1);
+            script->subMain.jumpTablePtr |= fileBuffer << 16;
+            FileRead(&fileBuffer, 1);
+            script->subMain.jumpTablePtr |= fileBuffer << 24;
+
+            FileRead(&fileBuffer, 1);
+            script->subPlayerInteraction.jumpTablePtr = fileBuffer;
+            FileRead(&fileBuffer, 1);
+            script->subPlayerInteraction.jumpTablePtr |= fileBuffer << 8;
+            FileRead(&fileBuffer, 1);
+            script->subPlayerInteraction.jumpTablePtr |= fileBuffer << 16;
+            FileRead(&fileBuffer, 1);
+            script->subPlayerInteraction.jumpTablePtr |= fileBuffer << 24;
+
+            FileRead(&fileBuffer, 1);
+            script->subDraw.jumpTablePtr = fileBuffer;
+            FileRead(&fileBuffer, 1);
+            script->subDraw.jumpTablePtr |= fileBuffer << 8;
+            FileRead(&fileBuffer, 1);
+            script->subDraw.jumpTablePtr |= fileBuffer << 16;
+            FileRead(&fileBuffer, 1);
+            script->subDraw.jumpTablePtr |= fileBuffer << 24;
+
+            FileRead(&fileBuffer, 1);
+            script->subStartup.jumpTablePtr = fileBuffer;
+            FileRead(&fileBuffer, 1);
+            script->subStartup.jumpTablePtr |= fileBuffer << 8;
+            FileRead(&fileBuffer, 1);
+            script->subStartup.jumpTablePtr |= fileBuffer << 16;
+            FileRead(&fileBuffer, 1);
+            script->subStartup.jumpTablePtr |= fileBuffer << 24;
+        }
+
+        FileRead(&fileBuffer, 1);
+        int functionCount = fileBuffer;
+        FileRead(&fileBuffer, 1);
+        functionCount |= fileBuffer << 8;
+
+        for (int f = 0; f < functionCount; ++f) {
+            ScriptFunction *function = &scriptFunctionList[f];
+
+            FileRead(&fileBuffer, 1);
+            function->ptr.scriptCodePtr = fileBuffer;
+            FileRead(&fileBuffer, 1);
+            function->ptr.scriptCodePtr |= fileBuffer << 8;
+            FileRead(&fileBuffer, 1);
+            function->ptr.scriptCodePtr |= fileBuffer << 16;
+            FileRead(&fileBuffer, 1);
+            function->ptr.scriptCodePtr |= fileBuffer << 24;
+        }
+
+        for (int f = 0; f < functionCount; ++f) {
+            ScriptFunction *function = &scriptFunctionList[f];
+
+            FileRead(&fileBuffer, 1);
+            function->ptr.jumpTablePtr = fileBuffer;
+            FileRead(&fileBuffer, 1);
+            function->ptr.jumpTablePtr |= fileBuffer << 8;
+            FileRead(&fileBuffer, 1);
+            function->ptr.jumpTablePtr |= fileBuffer << 16;
+            FileRead(&fileBuffer, 1);
+            function->ptr.jumpTablePtr |= fileBuffer << 24;
+        }
+
+        CloseFile();
+    }
+#endif
+}
+
+void ClearScriptData()
+{
+    memset(scriptCode, 0, SCRIPTDATA_COUNT * sizeof(int));
+    memset(jumpTable, 0, JUMPTABLE_COUNT * sizeof(int));
+
+    scriptFrameCount = 0;
+
+    scriptCodePos     = 0;
+    jumpTablePos      = 0;
+    jumpTableStackPos = 0;
+    functionStackPos  = 0;
+
+    scriptCodePos    = 0;
+    scriptCodeOffset = 0;
+    jumpTablePos     = 0;
+    jumpTableOffset  = 0;
+
+#if RETRO_USE_COMPILER
+    scriptFunctionCount = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    ClearScriptNameIndex(&globalVariableIndex);
+    ClearScriptNameIndex(&scriptFunctionIndex);
+    ClearScriptNameIndex(&typeNameIndex);
+#endif
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+    nativeSubBindings.clear();
+    memset(nativeFunctionList, 0, sizeof(nativeFunctionList));
+    memset(isolatedObjectTypes, 0, sizeof(isolatedObjectTypes));
+#endif
+
+    aliasCount = COMMONALIAS_COUNT;
+    lineID     = 0;
+
+    ClearGraphicsData();
+    ClearAnimationData();
+
+    for (int p = 0; p < PLAYER_COUNT; ++p) {
+        playerList[p].animationFile = GetDefaultAnimationRef();
+        playerList[p].boundEntity   = &objectEntityList[p];
+    }
+
+    for (int o = 0; o < OBJECT_COUNT; ++o) {
+        ObjectScript *scriptInfo                       = &objectScriptList[o];
+        scriptInfo->subMain.scriptCodePtr              = SCRIPTDATA_COUNT - 1;
+        scriptInfo->subMain.jumpTablePtr               = JUMPTABLE_COUNT - 1;
+        scriptInfo->subPlayerInteraction.scriptCodePtr = SCRIPTDATA_COUNT - 1;
+        scriptInfo->subPlayerInteraction.jumpTablePtr  = JUMPTABLE_COUNT - 1;
+        scriptInfo->subDraw.scriptCodePtr              = SCRIPTDATA_COUNT - 1;
+        scriptInfo->subDraw.jumpTablePtr               = JUMPTABLE_COUNT - 1;
+        scriptInfo->subStartup.scriptCodePtr           = SCRIPTDATA_COUNT - 1;
+        scriptInfo->subStartup.jumpTablePtr            = JUMPTABLE_COUNT - 1;
+        scriptInfo->frameListOffset                    = 0;
+        scriptInfo->spriteSheetID                      = 0;
+        scriptInfo->animFile                           = GetDefaultAnimationRef();
+        scriptInfo->mobile                             = true;
+        typeNames[o][0]                                = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+        typeSymbols[o] = SYMBOL_NONE;
+#endif
+    }
+
+    for (int f = 0; f < FUNCTION_COUNT; ++f) {
+        scriptFunctionList[f].ptr.scriptCodePtr = SCRIPTDATA_COUNT - 1;
+        scriptFunctionList[f].ptr.jumpTablePtr  = JUMPTABLE_COUNT - 1;
+    }
+
+    SetObjectTypeName((char *)"Blank Object", 0);
+
+    for (int s = 0; s < COLSTORE_COUNT; s++) {
+        collisionStorage[s].entityNo = -1;
+        collisionStorage[s].type     = -1;
+        collisionStorage[s].left     = 0;
+        collisionStorage[s].top      = 0;
+        collisionStorage[s].right    = 0;
+        collisionStorage[s].bottom   = 0;
+    }
+
+}
+
+#if !RETRO_USE_ORIGINAL_CODE
+// ================
+// NATIVE SCRIPTS
+// ================
+// Routines are matched to their translation by a hash of their bytecode, so anything modded or unknown keeps being interpreted.
+// The translation only covers control flow and arithmetic on plain variables, every other instruction is handed back to the
+// interpreter one at a time through RunScriptInstruction
+#define NATIVESCRIPT_VERSION    (1)
+#define NATIVESCRIPT_MAX_SWITCH (0x400)
+
+#if RETRO_USE_NATIVE_SCRIPTS
+#include "NativeScripts.hpp" // written by the "scriptaot=" tool mode
+#else
+const NativeScriptEntry nativeScriptTable[] = { { 0, nullptr } };
+const int nativeScriptTableCount = 0;
+#endif
+
+void RunScriptInstruction(int scriptCodePtr, byte scriptSub)
+{
+    scriptStepMode = SCRIPTSTEP_INSTRUCTION;
+    ProcessScript(scriptCodePtr, 0, scriptSub);
+    scriptStepMode = SCRIPTSTEP_NONE;
+}
+
+// Only fills scriptEng.operands, for translated opcodes reading variables that aren't translated
+void ReadScriptOperands(int scriptCodePtr, byte scriptSub)
+{
+    scriptStepMode = SCRIPTSTEP_OPERANDS;
+    ProcessScript(scriptCodePtr, 0, scriptSub);
+    scriptStepMode = SCRIPTSTEP_NONE;
+}
+
+struct ScriptOperandInfo {
+    int type;
+    int arrayType;
+    bool arrayIsPos; // index is scriptEng.arrayPosition[arrayIndex] rather than arrayIndex itself
+    int arrayIndex;
+    int variable;
+    int value;
+};
+
+struct ScriptInstructionInfo {
+    int opcode;
+    int size;
+    int operandCount;
+    ScriptOperandInfo operands[10];
+};
+
+struct ScriptRoutineInfo {
+    int size;
+    int jumpTableSize;
+    unsigned long long hash;
+    std::vector<int> offsets;
+    std::vector<int> blocks; // jump table entry of the if/while/switch an else, loop or break belongs to
+    std::vector<int> targets;
+    std::vector<int> callees;
+};
+
+bool DecodeScriptInstruction(int scriptCodePtr, ScriptInstructionInfo *ins)
+{
+    int pos = scriptCodePtr;
+    if (pos < 0 || pos >= scriptCodePos)
+        return false;
+
+    ins->opcode = scriptCode[pos++];
+    if (ins->opcode < 0 || ins->opcode >= (int)(sizeof(functions) / sizeof(functions[0])))
+        return false;
+
+    ins->operandCount = functions[ins->opcode].opcodeSize;
+    for (int i = 0; i < ins->operandCount; ++i) {
+        ScriptOperandInfo *op = &ins->operands[i];
+        if (pos >= scriptCodePos)
+            return false;
+
+        op->type = scriptCode[pos++];
+        switch (op->type) {
+            case SCRIPTVAR_VAR:
+                op->arrayType  = scriptCode[pos++];
+                op->arrayIsPos = false;
+                op->arrayIndex = 0;
+                if (op->arrayType >= VARARR_ARRAY && op->arrayType <= VARARR_ENTNOMINUS1) {
+                    op->arrayIsPos = scriptCode[pos++] == 1;
+                    op->arrayIndex = scriptCode[pos++];
+                }
+                op->variable = scriptCode[pos++];
+                break;
+
+            case SCRIPTVAR_INTCONST: op->value = scriptCode[pos++]; break;
+
+            case SCRIPTVAR_STRCONST: {
+                int strLen = scriptCode[pos++];
+                if (strLen < 0 || strLen >= (int)sizeof(scriptText))
+                    return false;
+                pos += strLen / 4 + 1;
+                break;
+            }
+
+            default: return false;
+        }
+    }
+
+    ins->size = pos - scriptCodePtr;
+    return pos <= scriptCodePos;
+}
+
+inline bool AddScriptRoutineTarget(ScriptRoutineInfo *info, int jumpTableStart, int entry, int *maxTarget)
+{
+    if (entry < 0 || jumpTableStart + entry >= JUMPTABLE_COUNT)
+        return false;
+    if (entry >= info->jumpTableSize)
+        info->jumpTableSize = entry + 1;
+
+    int target = jumpTable[jumpTableStart + entry];
+    if (target < 0)
+        return false;
+    if (target > *maxTarget)
+        *maxTarget = target;
+    info->targets.push_back(target);
+    return true;
+}
+
+// Finds where a routine ends, checks its if/while/switch blocks nest the way the compiler writes them and hashes it.
+// Functions that return from inside a block leave entries on jumpTableStack for their caller, so those aren't translated
+bool ScanScriptRoutine(int scriptCodeStart, int jumpTableStart, bool function, ScriptRoutineInfo *info)
+{
+    info->size          = 0;
+    info->jumpTableSize = 0;
+    info->hash          = 0;
+    info->offsets.clear();
+    info->blocks.clear();
+    info->targets.clear();
+    info->callees.clear();
+    if (scriptCodeStart < 0 || jumpTableStart < 0 || jumpTableStart >= JUMPTABLE_COUNT)
+        return false;
+
+    std::vector<int> blockStack;
+    int maxTarget = 0;
+    int pos       = scriptCodeStart;
+    bool finished = false;
+    while (!finished) {
+        ScriptInstructionInfo ins;
+        if (!DecodeScriptInstruction(pos, &ins))
+            return false;
+
+        int offset = pos - scriptCodeStart;
+        int entry  = -1;
+        if (ins.operandCount && ins.operands[0].type == SCRIPTVAR_INTCONST)
+            entry = ins.operands[0].value;
+        int block = blockStack.empty() ? -1 : blockStack.back();
+
+        info->offsets.push_back(offset);
+        info->blocks.push_back(-1);
+        pos += ins.size;
+
+        switch (ins.opcode) {
+            default: break;
+
+            case FUNC_IFEQUAL:
+            case FUNC_IFGREATER:
+            case FUNC_IFGREATEROREQUAL:
+            case FUNC_IFLOWER:
+            case FUNC_IFLOWEROREQUAL:
+            case FUNC_IFNOTEQUAL:
+                if (entry < 0 || !AddScriptRoutineTarget(info, jumpTableStart, entry, &maxTarget))
+                    return false;
+                blockStack.push_back(entry);
+                break;
+
+            case FUNC_WEQUAL:
+            case FUNC_WGREATER:
+            case FUNC_WGREATEROREQUAL:
+            case FUNC_WLOWER:
+            case FUNC_WLOWEROREQUAL:
+            case FUNC_WNOTEQUAL:
+                if (entry < 0 || !AddScriptRoutineTarget(info, jumpTableStart, entry + 1, &maxTarget))
+                    return false;
+                blockStack.push_back(entry);
+                break;
+
+            case FUNC_SWITCH: {
+                if (entry < 0 || jumpTableStart + entry + 1 >= JUMPTABLE_COUNT)
+                    return false;
+                int low  = jumpTable[jumpTableStart + entry];
+                int high = jumpTable[jumpTableStart + entry + 1];
+                if (high < low || high - low > NATIVESCRIPT_MAX_SWITCH)
+                    return false;
+                if (!AddScriptRoutineTarget(info, jumpTableStart, entry + 2, &maxTarget))
+                    return false;
+                for (int c = 0; c <= high - low; ++c) {
+                    if (!AddScriptRoutineTarget(info, jumpTableStart, entry + 4 + c, &maxTarget))
+                        return false;
+                }
+                blockStack.push_back(entry);
+                break;
+            }
+
+            case FUNC_ELSE:
+            case FUNC_BREAK:
+            case FUNC_LOOP:
+                if (block < 0)
+                    return false;
+                info->blocks.back() = block;
+                if (!AddScriptRoutineTarget(info, jumpTableStart, block + (ins.opcode == FUNC_ELSE ? 1 : ins.opcode == FUNC_BREAK ? 3 : 0),
+                                            &maxTarget))
+                    return false;
+                if (ins.opcode == FUNC_LOOP)
+                    blockStack.pop_back();
+                break;
+
+            case FUNC_ENDIF:
+            case FUNC_ENDSWITCH:
+                if (block < 0)
+                    return false;
+                blockStack.pop_back();
+                break;
+
+            case FUNC_CALLFUNCTION:
+                if (entry < 0 || entry >= FUNCTION_COUNT)
+                    return false;
+                info->callees.push_back(entry);
+                break;
+
+            case FUNC_ENDFUNCTION:
+                if (!function || !blockStack.empty())
+                    return false;
+                finished = offset >= maxTarget;
+                break;
+
+            case FUNC_END: finished = !function && blockStack.empty() && offset >= maxTarget; break;
+        }
+    }
+
+    // every jump has to land on an instruction inside the routine, as labels in the translation
+    for (int target : info->targets) {
+        if (!std::binary_search(info->offsets.begin(), info->offsets.end(), target))
+            return false;
+    }
+
+    info->size         = pos - scriptCodeStart;
+    int version        = NATIVESCRIPT_VERSION;
+    unsigned long long hash = 0xCBF29CE484222325ULL;
+    hash               = HashScriptCacheBytes(hash, &version, sizeof(int));
+    hash               = HashScriptCacheBytes(hash, &function, sizeof(bool));
+    hash               = HashScriptCacheBytes(hash, &scriptCode[scriptCodeStart], info->size * sizeof(int));
+    info->hash         = HashScriptCacheBytes(hash, &jumpTable[jumpTableStart], info->jumpTableSize * sizeof(int));
+    return true;
+}
+
+NativeScript LookupNativeScript(unsigned long long hash)
+{
+    int start = 0;
+    int end   = nativeScriptTableCount;
+    while (start < end) {
+        int mid = (start + end) / 2;
+        if (nativeScriptTable[mid].hash < hash)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+    if (start < nativeScriptTableCount && nativeScriptTable[start].hash == hash)
+        return nativeScriptTable[start].script;
+    return nullptr;
+}
+
+// Matches every loaded object subroutine and function against the translated ones, a routine only runs natively if every
+// function it calls does too
+void BindNativeScripts()
+{
+    nativeSubBindings.clear();
+    memset(nativeFunctionList, 0, sizeof(nativeFunctionList));
+    if (!nativeScriptTableCount)
+        return;
+
+    ScriptRoutineInfo info;
+    std::vector<int> functionCallees[FUNCTION_COUNT];
+    for (int f = 0; f < FUNCTION_COUNT; ++f) {
+        ScriptPtr *ptr = &scriptFunctionList[f].ptr;
+        if (ptr->scriptCodePtr < scriptCodePos && ScanScriptRoutine(ptr->scriptCodePtr, ptr->jumpTablePtr, true, &info)) {
+            nativeFunctionList[f] = LookupNativeScript(info.hash);
+            functionCallees[f]    = info.callees;
+        }
+    }
+
+    bool unbound = true;
+    while (unbound) {
+        unbound = false;
+        for (int f = 0; f < FUNCTION_COUNT; ++f) {
+            if (!nativeFunctionList[f])
+                continue;
+            for (int callee : functionCallees[f]) {
+                if (!nativeFunctionList[callee]) {
+                    nativeFunctionList[f] = nullptr;
+                    unbound               = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    int subCount = 0;
+    for (int o = 0; o < OBJECT_COUNT; ++o) {
+        for (int s = SUB_MAIN; s <= SUB_SETUP; ++s) {
+            ScriptPtr *ptr = GetScriptSubPtr(&objectScriptList[o], s);
+            if (ptr->scriptCodePtr >= scriptCodePos)
+                continue;
+
+            ++subCount;
+            if (!ScanScriptRoutine(ptr->scriptCodePtr, ptr->jumpTablePtr, false, &info))
+                continue;
+            NativeScript native = LookupNativeScript(info.hash);
+            for (int callee : info.callees) {
+                if (!nativeFunctionList[callee])
+                    native = nullptr;
+            }
+            if (native)
+                nativeSubBindings.push_back({ ptr->scriptCodePtr, native });
+        }
+    }
+    std::sort(nativeSubBindings.begin(), nativeSubBindings.end(),
+              [](const NativeScriptBinding &a, const NativeScriptBinding &b) { return a.scriptCodePtr < b.scriptCodePtr; });
+
+    int functionCount = 0;
+    for (int f = 0; f < FUNCTION_COUNT; ++f) functionCount += nativeFunctionList[f] != nullptr;
+    PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_INFO, "Bound %d of %d object subs and %d functions to native scripts", (int)nativeSubBindings.size(),
+                     subCount, functionCount);
+}
+
+NativeScript FindNativeScript(int scriptCodePtr)
+{
+    int start = 0;
+    int end   = (int)nativeSubBindings.size();
+    while (start < end) {
+        int mid = (start + end) / 2;
+        if (nativeSubBindings[mid].scriptCodePtr < scriptCodePtr)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+    if (start < (int)nativeSubBindings.size() && nativeSubBindings[start].scriptCodePtr == scriptCodePtr)
+        return nativeSubBindings[start].script;
+    return nullptr;
+}
+
+// ================
+// TRANSLATOR
+// ================
+void AppendNativeText(std::string &text, const char *format, ...)
+{
+    char buffer[0x400];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    text += buffer;
+}
+
+enum NativeVariableFlags { NATIVEVAR_NONE = 0, NATIVEVAR_READONLY = 1, NATIVEVAR_INTPOS = 2, NATIVEVAR_HOTFIELD = 4 };
+
+// Writes the C++ lvalue for a variable, for the ones whose getter and setter are plain loads and stores in ProcessScript
+#define NATIVEVAR_TEXTSIZE (0x80)
+
+bool GetNativeVariable(const ScriptOperandInfo *op, char *lvalue, char *slot, int *flags)
+{
+    if (op->type != SCRIPTVAR_VAR || op->arrayType < VARARR_NONE || op->arrayType > VARARR_ENTNOMINUS1)
+        return false;
+    if (op->arrayIsPos && (op->arrayIndex < 0 || op->arrayIndex > 2))
+        return false;
+
+    const int size = NATIVEVAR_TEXTSIZE;
+    switch (op->arrayType) {
+        default:
+        case VARARR_NONE: StrCopy(slot, "objectLoop"); break;
+        case VARARR_ARRAY:
+            if (op->arrayIsPos)
+                snprintf(slot, size, "scriptEng.arrayPosition[%d]", op->arrayIndex);
+            else
+                snprintf(slot, size, "%d", op->arrayIndex);
+            break;
+        case VARARR_ENTNOPLUS1:
+            if (op->arrayIsPos)
+                snprintf(slot, size, "scriptEng.arrayPosition[%d] + objectLoop", op->arrayIndex);
+            else
+                snprintf(slot, size, "%d + objectLoop", op->arrayIndex);
+            break;
+        case VARARR_ENTNOMINUS1:
+            if (op->arrayIsPos)
+                snprintf(slot, size, "objectLoop - scriptEng.arrayPosition[%d]", op->arrayIndex);
+            else
+                snprintf(slot, size, "objectLoop - %d", op->arrayIndex);
+            break;
+    }
+
+    const char *field = nullptr;
+    *flags            = NATIVEVAR_NONE;
+    switch (op->variable) {
+        default: return false;
+        case VAR_TEMPVALUE0:
+        case VAR_TEMPVALUE1:
+        case VAR_TEMPVALUE2:
+        case VAR_TEMPVALUE3:
+        case VAR_TEMPVALUE4:
+        case VAR_TEMPVALUE5:
+        case VAR_TEMPVALUE6:
+        case VAR_TEMPVALUE7: snprintf(lvalue, size, "scriptEng.tempValue[%d]", op->variable - VAR_TEMPVALUE0); return true;
+        case VAR_CHECKRESULT: StrCopy(lvalue, "scriptEng.checkResult"); return true;
+        case VAR_ARRAYPOS0:
+        case VAR_ARRAYPOS1: snprintf(lvalue, size, "scriptEng.arrayPosition[%d]", op->variable - VAR_ARRAYPOS0); return true;
+        case VAR_GLOBAL: snprintf(lvalue, size, "globalVariables[%s]", slot); return true;
+        case VAR_OBJECTENTITYNO:
+            StrCopy(lvalue, slot);
+            *flags = NATIVEVAR_READONLY;
+            return true;
+
+        case VAR_PLAYERXPOS: StrCopy(lvalue, "playerList[activePlayer].XPos"); return true;
+        case VAR_PLAYERYPOS: StrCopy(lvalue, "playerList[activePlayer].YPos"); return true;
+        case VAR_PLAYERIXPOS:
+            StrCopy(lvalue, "playerList[activePlayer].XPos");
+            *flags = NATIVEVAR_INTPOS;
+            return true;
+        case VAR_PLAYERIYPOS:
+            StrCopy(lvalue, "playerList[activePlayer].YPos");
+            *flags = NATIVEVAR_INTPOS;
+            return true;
+        case VAR_PLAYERSPEED: StrCopy(lvalue, "playerList[activePlayer].speed"); return true;
+        case VAR_PLAYERXVELOCITY: StrCopy(lvalue, "playerList[activePlayer].XVelocity"); return true;
+        case VAR_PLAYERYVELOCITY: StrCopy(lvalue, "playerList[activePlayer].YVelocity"); return true;
+        case VAR_PLAYERGRAVITY: StrCopy(lvalue, "playerList[activePlayer].gravity"); return true;
+        case VAR_PLAYERANGLE: StrCopy(lvalue, "playerList[activePlayer].angle"); return true;
+
+        case VAR_OBJECTTYPE:
+            field  = "type";
+            *flags = NATIVEVAR_HOTFIELD;
+            break;
+        case VAR_OBJECTPROPERTYVALUE: field = "propertyValue"; break;
+        case VAR_OBJECTXPOS:
+            field  = "XPos";
+            *flags = NATIVEVAR_HOTFIELD;
+            break;
+        case VAR_OBJECTYPOS:
+            field  = "YPos";
+            *flags = NATIVEVAR_HOTFIELD;
+            break;
+        case VAR_OBJECTIXPOS:
+            field  = "XPos";
+            *flags = NATIVEVAR_HOTFIELD | NATIVEVAR_INTPOS;
+            break;
+        case VAR_OBJECTIYPOS:
+            field  = "YPos";
+            *flags = NATIVEVAR_HOTFIELD | NATIVEVAR_INTPOS;
+            break;
+        case VAR_OBJECTSTATE: field = "state"; break;
+        case VAR_OBJECTROTATION: field = "rotation"; break;
+        case VAR_OBJECTSCALE: field = "scale"; break;
+        case VAR_OBJECTPRIORITY:
+            field  = "priority";
+            *flags = NATIVEVAR_HOTFIELD;
+            break;
+        case VAR_OBJECTDRAWORDER:
+            field  = "drawOrder";
+            *flags = NATIVEVAR_HOTFIELD;
+            break;
+        case VAR_OBJECTDIRECTION: field = "direction"; break;
+        case VAR_OBJECTINKEFFECT: field = "inkEffect"; break;
+        case VAR_OBJECTALPHA: field = "alpha"; break;
+        case VAR_OBJECTFRAME: field = "frame"; break;
+        case VAR_OBJECTANIMATION: field = "animation"; break;
+        case VAR_OBJECTPREVANIMATION: field = "prevAnimation"; break;
+        case VAR_OBJECTANIMATIONSPEED: field = "animationSpeed"; break;
+        case VAR_OBJECTANIMATIONTIMER: field = "animationTimer"; break;
+        case VAR_OBJECTVALUE0:
+        case VAR_OBJECTVALUE1:
+        case VAR_OBJECTVALUE2:
+        case VAR_OBJECTVALUE3:
+        case VAR_OBJECTVALUE4:
+        case VAR_OBJECTVALUE5:
+        case VAR_OBJECTVALUE6:
+        case VAR_OBJECTVALUE7: snprintf(lvalue, size, "objectEntityList[%s].values[%d]", slot, op->variable - VAR_OBJECTVALUE0); return true;
+    }
+
+    snprintf(lvalue, size, "objectEntityList[%s].%s", slot, field);
+    return true;
+}
+
+bool IsNativeOperand(const ScriptOperandInfo *op)
+{
+    char lvalue[NATIVEVAR_TEXTSIZE];
+    char slot[NATIVEVAR_TEXTSIZE];
+    int flags = 0;
+    return op->type == SCRIPTVAR_INTCONST || GetNativeVariable(op, lvalue, slot, &flags);
+}
+
+void AppendNativeOperandReads(std::string &text, const ScriptInstructionInfo *ins)
+{
+    for (int i = 0; i < ins->operandCount; ++i) {
+        const ScriptOperandInfo *op = &ins->operands[i];
+        if (op->type == SCRIPTVAR_INTCONST) {
+            AppendNativeText(text, "    scriptEng.operands[%d] = %d;\n", i, op->value);
+            continue;
+        }
+
+        char lvalue[NATIVEVAR_TEXTSIZE];
+        char slot[NATIVEVAR_TEXTSIZE];
+        int flags = 0;
+        GetNativeVariable(op, lvalue, slot, &flags);
+        AppendNativeText(text, "    scriptEng.operands[%d] = %s%s;\n", i, lvalue, (flags & NATIVEVAR_INTPOS) ? " >> 16" : "");
+    }
+}
+
+// Matches ProcessScript's "Set Values" pass, which writes back every variable operand in order even if the opcode didn't change it
+void AppendNativeOperandWrites(std::string &text, const ScriptInstructionInfo *ins)
+{
+    for (int i = 0; i < ins->operandCount; ++i) {
+        const ScriptOperandInfo *op = &ins->operands[i];
+        char lvalue[NATIVEVAR_TEXTSIZE];
+        char slot[NATIVEVAR_TEXTSIZE];
+        int flags = 0;
+        if (op->type != SCRIPTVAR_VAR || !GetNativeVariable(op, lvalue, slot, &flags) || (flags & NATIVEVAR_READONLY))
+            continue;
+
+        AppendNativeText(text, "    %s = scriptEng.operands[%d]%s;\n", lvalue, i, (flags & NATIVEVAR_INTPOS) ? " << 16" : "");
+        if (flags & NATIVEVAR_HOTFIELD)
+            AppendNativeText(text, "    SyncEntityHotFields(%s);\n", slot);
+    }
+}
+
+// Statements ProcessScript runs for the opcodes translated as straight-line code, nullptr for the ones that aren't
+const char *GetNativeOpcodeText(int opcode, bool *writeBack)
+{
+    *writeBack = true;
+    switch (opcode) {
+        default: break;
+        case FUNC_EQUAL: return "    scriptEng.operands[0] = scriptEng.operands[1];\n";
+        case FUNC_ADD: return "    scriptEng.operands[0] += scriptEng.operands[1];\n";
+        case FUNC_SUB: return "    scriptEng.operands[0] -= scriptEng.operands[1];\n";
+        case FUNC_INC: return "    ++scriptEng.operands[0];\n";
+        case FUNC_DEC: return "    --scriptEng.operands[0];\n";
+        case FUNC_MUL: return "    scriptEng.operands[0] *= scriptEng.operands[1];\n";
+        case FUNC_DIV: return "    scriptEng.operands[0] /= scriptEng.operands[1];\n";
+        case FUNC_SHR: return "    scriptEng.operands[0] >>= scriptEng.operands[1];\n";
+        case FUNC_SHL: return "    scriptEng.operands[0] <<= scriptEng.operands[1];\n";
+        case FUNC_AND: return "    scriptEng.operands[0] &= scriptEng.operands[1];\n";
+        case FUNC_OR: return "    scriptEng.operands[0] |= scriptEng.operands[1];\n";
+        case FUNC_XOR: return "    scriptEng.operands[0] ^= scriptEng.operands[1];\n";
+        case FUNC_MOD: return "    scriptEng.operands[0] %= scriptEng.operands[1];\n";
+        case FUNC_FLIPSIGN: return "    scriptEng.operands[0] = -scriptEng.operands[0];\n";
+        case FUNC_SIN: return "    scriptEng.operands[0] = Sin512(scriptEng.operands[1]);\n";
+        case FUNC_COS: return "    scriptEng.operands[0] = Cos512(scriptEng.operands[1]);\n";
+        case FUNC_SIN256: return "    scriptEng.operands[0] = Sin256(scriptEng.operands[1]);\n";
+        case FUNC_COS256: return "    scriptEng.operands[0] = Cos256(scriptEng.operands[1]);\n";
+        case FUNC_SINCHANGE:
+            return "    scriptEng.operands[0] = scriptEng.operands[3] + (Sin512(scriptEng.operands[1]) >> scriptEng.operands[2]) - "
+                   "scriptEng.operands[4];\n";
+        case FUNC_COSCHANGE:
+            return "    scriptEng.operands[0] = scriptEng.operands[3] + (Cos512(scriptEng.operands[1]) >> scriptEng.operands[2]) - "
+                   "scriptEng.operands[4];\n";
+        case FUNC_ATAN2: return "    scriptEng.operands[0] = ArcTanLookup(scriptEng.operands[1], scriptEng.operands[2]);\n";
+        case FUNC_INTERPOLATE:
+            return "    scriptEng.operands[0] = (scriptEng.operands[2] * (0x100 - scriptEng.operands[3]) + scriptEng.operands[3] * "
+                   "scriptEng.operands[1]) >> 8;\n";
+        case FUNC_INTERPOLATEXY:
+            return "    scriptEng.operands[0] = (scriptEng.operands[3] * (0x100 - scriptEng.operands[6]) >> 8) + ((scriptEng.operands[6] * "
+                   "scriptEng.operands[2]) >> 8);\n"
+                   "    scriptEng.operands[1] = (scriptEng.operands[5] * (0x100 - scriptEng.operands[6]) >> 8) + (scriptEng.operands[6] * "
+                   "scriptEng.operands[4] >> 8);\n";
+    }
+
+    *writeBack = false;
+    switch (opcode) {
+        default: return nullptr;
+        case FUNC_CHECKEQUAL: return "    scriptEng.checkResult = scriptEng.operands[0] == scriptEng.operands[1];\n";
+        case FUNC_CHECKGREATER: return "    scriptEng.checkResult = scriptEng.operands[0] > scriptEng.operands[1];\n";
+        case FUNC_CHECKLOWER: return "    scriptEng.checkResult = scriptEng.operands[0] < scriptEng.operands[1];\n";
+        case FUNC_CHECKNOTEQUAL: return "    scriptEng.checkResult = scriptEng.operands[0] != scriptEng.operands[1];\n";
+    }
+}
+
+// The comparison that makes an if or while opcode jump past its block
+const char *GetNativeSkipCondition(int opcode)
+{
+    switch (opcode) {
+        default: return nullptr;
+        case FUNC_IFEQUAL:
+        case FUNC_WEQUAL: return "scriptEng.operands[1] != scriptEng.operands[2]";
+        case FUNC_IFGREATER:
+        case FUNC_WGREATER: return "scriptEng.operands[1] <= scriptEng.operands[2]";
+        case FUNC_IFGREATEROREQUAL:
+        case FUNC_WGREATEROREQUAL: return "scriptEng.operands[1] < scriptEng.operands[2]";
+        case FUNC_IFLOWER:
+        case FUNC_WLOWER: return "scriptEng.operands[1] >= scriptEng.operands[2]";
+        case FUNC_IFLOWEROREQUAL:
+        case FUNC_WLOWEROREQUAL: return "scriptEng.operands[1] > scriptEng.operands[2]";
+        case FUNC_IFNOTEQUAL:
+        case FUNC_WNOTEQUAL: return "scriptEng.operands[1] == scriptEng.operands[2]";
+    }
+}
+
+void AppendNativeScript(std::string &text, int scriptCodeStart, int jumpTableStart, const ScriptRoutineInfo *info)
+{
+    std::string body;
+    bool usesStart = false;
+    bool usesSub   = false;
+
+    std::vector<int> targets = info->targets;
+    std::sort(targets.begin(), targets.end());
+
+    for (int i = 0; i < (int)info->offsets.size(); ++i) {
+        int offset = info->offsets[i];
+        ScriptInstructionInfo ins;
+        DecodeScriptInstruction(scriptCodeStart + offset, &ins);
+
+        if (std::binary_search(targets.begin(), targets.end(), offset))
+            AppendNativeText(body, "L_%d:\n", offset);
+        AppendNativeText(body, "    // %s\n", functions[ins.opcode].name);
+
+        bool native = true;
+        for (int o = 0; o < ins.operandCount; ++o) native &= IsNativeOperand(&ins.operands[o]);
+
+        const int *jumps = &jumpTable[jumpTableStart];
+        int block        = info->blocks[i];
+        bool writeBack   = false;
+        const char *code = GetNativeOpcodeText(ins.opcode, &writeBack);
+        switch (ins.opcode) {
+            case FUNC_END: body += "    return true;\n"; break;
+            case FUNC_ENDFUNCTION: body += "    return false;\n"; break;
+            case FUNC_ENDIF:
+            case FUNC_ENDSWITCH: break;
+            case FUNC_ELSE: AppendNativeText(body, "    goto L_%d;\n", jumps[block + 1]); break;
+            case FUNC_LOOP: AppendNativeText(body, "    goto L_%d;\n", jumps[block]); break;
+            case FUNC_BREAK: AppendNativeText(body, "    goto L_%d;\n", jumps[block + 3]); break;
+
+            case FUNC_CALLFUNCTION: {
+                int function = ins.operands[0].value;
+                AppendNativeText(body, "    scriptEng.operands[0] = %d;\n", function);
+                AppendNativeText(body, "    if (nativeFunctionList[%d](scriptFunctionList[%d].ptr.scriptCodePtr, scriptSub))\n        return true;\n",
+                                 function, function);
+                usesSub = true;
+                break;
+            }
+
+            case FUNC_IFEQUAL:
+            case FUNC_IFGREATER:
+            case FUNC_IFGREATEROREQUAL:
+            case FUNC_IFLOWER:
+            case FUNC_IFLOWEROREQUAL:
+            case FUNC_IFNOTEQUAL:
+            case FUNC_WEQUAL:
+            case FUNC_WGREATER:
+            case FUNC_WGREATEROREQUAL:
+            case FUNC_WLOWER:
+            case FUNC_WLOWEROREQUAL:
+            case FUNC_WNOTEQUAL:
+            case FUNC_SWITCH: {
+                if (native) {
+                    AppendNativeOperandReads(body, &ins);
+                }
+                else {
+                    AppendNativeText(body, "    ReadScriptOperands(scriptCodeStart + %d, scriptSub);\n", offset);
+                    usesStart = usesSub = true;
+                }
+
+                int entry = ins.operands[0].value;
+                if (ins.opcode == FUNC_SWITCH) {
+                    int low  = jumps[entry];
+                    int high = jumps[entry + 1];
+                    body += "    switch (scriptEng.operands[1]) {\n";
+                    for (int c = low; c <= high; ++c) AppendNativeText(body, "        case %d: goto L_%d;\n", c, jumps[entry + 4 + (c - low)]);
+                    AppendNativeText(body, "        default: goto L_%d;\n    }\n", jumps[entry + 2]);
+                }
+                else {
+                    bool loop = ins.opcode >= FUNC_WEQUAL;
+                    AppendNativeText(body, "    if (%s)\n        goto L_%d;\n", GetNativeSkipCondition(ins.opcode), jumps[entry + (loop ? 1 : 0)]);
+                }
+                break;
+            }
+
+            default:
+                if (code && (native || !writeBack)) {
+                    if (native) {
+                        AppendNativeOperandReads(body, &ins);
+                    }
+                    else {
+                        AppendNativeText(body, "    ReadScriptOperands(scriptCodeStart + %d, scriptSub);\n", offset);
+                        usesStart = usesSub = true;
+                    }
+                    body += code;
+                    if (writeBack)
+                        AppendNativeOperandWrites(body, &ins);
+                }
+                else {
+                    AppendNativeText(body, "    RunScriptInstruction(scriptCodeStart + %d, scriptSub);\n", offset);
+                    usesStart = usesSub = true;
+                }
+                break;
+        }
+    }
+
+    AppendNativeText(text, "// %d words of bytecode\nstatic bool NativeScript_%016llX(int%s, byte%s)\n{\n", info->size, info->hash,
+                     usesStart ? " scriptCodeStart" : "", usesSub ? " scriptSub" : "");
+    text += body;
+    text += "}\n\n";
+}
+
+void TranslateLoadedScripts(std::string &text, std::set<unsigned long long> &translated, int *skipped)
+{
+    ScriptRoutineInfo info;
+    for (int r = 0; r < FUNCTION_COUNT + OBJECT_COUNT * 4; ++r) {
+        bool function  = r < FUNCTION_COUNT;
+        ScriptPtr *ptr = function ? &scriptFunctionList[r].ptr : GetScriptSubPtr(&objectScriptList[(r - FUNCTION_COUNT) / 4], (r - FUNCTION_COUNT) % 4);
+        if (ptr->scriptCodePtr >= scriptCodePos)
+            continue;
+
+        if (!ScanScriptRoutine(ptr->scriptCodePtr, ptr->jumpTablePtr, function, &info))
+            ++*skipped;
+        else if (translated.insert(info.hash).second)
+            AppendNativeScript(text, ptr->scriptCodePtr, ptr->jumpTablePtr, &info);
+    }
+}
+
+// Tool mode: translates the object subs and functions of every stage's bytecode into NativeScripts.hpp
+int TranslateScriptBytecode(const char *outputPath)
+{
+    if (!Engine.usingBytecode) {
+        PrintLog("scriptaot: the game data has no compiled bytecode to translate");
+        return 1;
+    }
+
+    std::string routines;
+    std::set<unsigned long long> translated;
+    int skipped = 0;
+    for (int l = 0; l < STAGELIST_MAX; ++l) {
+        for (int s = 0; s < stageListCount[l]; ++s) {
+            activeStageList   = l;
+            stageListPosition = s;
+            ClearScriptData();
+            for (int f = 0; f < FUNCTION_COUNT; ++f) scriptFunctionList[f].ptr.scriptCodePtr = SCRIPTDATA_COUNT - 1;
+
+            // same order LoadStageFiles uses, stage bytecode is laid out after the global code when the stage loads it
+            FileInfo info;
+            bool loadGlobalScripts = false;
+            if (LoadStageFile("StageConfig.bin", s, &info)) {
+                byte buf = 0;
+                FileRead(&buf, 1);
+                loadGlobalScripts = buf;
+                CloseFile();
+            }
+            if (loadGlobalScripts) {
+                LoadBytecode(4, 1);
+                TranslateLoadedScripts(routines, translated, &skipped);
+            }
+            LoadBytecode(l, 1);
+            TranslateLoadedScripts(routines, translated, &skipped);
+        }
+    }
+
+    std::string text;
+    text += "// Generated by the \"scriptaot=\" tool mode from the game's compiled bytecode, don't edit by hand.\n";
+    text += "// Included by Script.cpp when RETRO_USE_NATIVE_SCRIPTS is (1)\n\n";
+    text += routines;
+    text += "const NativeScriptEntry nativeScriptTable[] = {\n";
+    for (unsigned long long hash : translated) AppendNativeText(text, "    { 0x%016llXULL, NativeScript_%016llX },\n", hash, hash);
+    if (translated.empty())
+        text += "    { 0, nullptr },\n";
+    text += "};\n";
+    AppendNativeText(text, "const int nativeScriptTableCount = %d;\n", (int)translated.size());
+
+    FileIO *file = fOpen(outputPath, "wb");
+    if (!file) {
+        PrintLog("scriptaot: couldn't write %s", outputPath);
+        return 1;
+    }
+    fWrite(text.data(), 1, text.size(), file);
+    fClose(file);
+
+    PrintLog("scriptaot: wrote %d routines to %s, %d routine loads couldn't be translated and stay interpreted", (int)translated.size(), outputPath,
+             skipped);
+    return 0;
+}
+#endif
+
+#if !RETRO_USE_ORIGINAL_CODE
+// ================
+// ISOLATED OBJECTS
+// ================
+// An object type is isolated when its main sub only reads and writes its own entity and the script registers, through
+// plain arithmetic and control flow, and it has no player interaction sub. Its entities can then update on the object
+// workers, each run using its own copy of the registers. For that copy to give the same results the sub also has to write
+// every register before reading it, which the dataflow pass below checks
+#define ISOLATED_REG_CHECKRESULT (1 << 8)
+#define ISOLATED_REG_ALL         (0x7FF)
+#define ISOLATED_CONSTANT        (-1)
+
+enum IsolatedRoutineStatus { ISOLATED_UNKNOWN, ISOLATED_SCANNING, ISOLATED_VALID, ISOLATED_INVALID };
+
+struct IsolatedOperand {
+    short variable; // ISOLATED_CONSTANT for int constants
+    int value;
+};
+
+struct IsolatedInstruction {
+    byte opcode;
+    byte operandCount;
+    int target; // instruction index the opcode jumps to, for switch the start of its entry in IsolatedRoutine::cases
+    IsolatedOperand operands[10];
+};
+
+struct IsolatedRoutine {
+    std::vector<IsolatedInstruction> code;
+    std::vector<int> cases; // low, high, default, then one instruction index per case
+    int inputs;             // registers read before the routine writes them
+    int outputs;            // registers written on every path that returns from a function
+    int status;
+};
+
+bool isolatedObjectTypes[OBJECT_COUNT];
+IsolatedRoutine isolatedMainSubs[OBJECT_COUNT];
+IsolatedRoutine isolatedFunctions[FUNCTION_COUNT];
+
+// Bit for the temp value, checkResult and arrayPos variables, 0 for the variables that aren't registers
+inline int GetIsolatedRegister(int variable)
+{
+    if (variable >= VAR_TEMPVALUE0 && variable <= VAR_TEMPVALUE7)
+        return 1 << (variable - VAR_TEMPVALUE0);
+    if (variable == VAR_CHECKRESULT)
+        return ISOLATED_REG_CHECKRESULT;
+    if (variable == VAR_ARRAYPOS0 || variable == VAR_ARRAYPOS1)
+        return ISOLATED_REG_CHECKRESULT << (1 + variable - VAR_ARRAYPOS0);
+    return 0;
+}
+
+bool IsIsolatedOperand(const ScriptOperandInfo *op)
+{
+    if (op->type == SCRIPTVAR_INTCONST)
+        return true;
+    if (op->type != SCRIPTVAR_VAR)
+        return false;
+    if (GetIsolatedRegister(op->variable))
+        return true; // the array index is worked out but not used for these
+
+    if (op->arrayType != VARARR_NONE)
+        return false;
+    switch (op->variable) {
+        default: return false;
+        case VAR_OBJECTENTITYNO:
+        case VAR_OBJECTTYPE:
+        case VAR_OBJECTPROPERTYVALUE:
+        case VAR_OBJECTXPOS:
+        case VAR_OBJECTYPOS:
+        case VAR_OBJECTIXPOS:
+        case VAR_OBJECTIYPOS:
+        case VAR_OBJECTSTATE:
+        case VAR_OBJECTROTATION:
+        case VAR_OBJECTSCALE:
+        case VAR_OBJECTPRIORITY:
+        case VAR_OBJECTDRAWORDER:
+        case VAR_OBJECTDIRECTION:
+        case VAR_OBJECTINKEFFECT:
+        case VAR_OBJECTALPHA:
+        case VAR_OBJECTFRAME:
+        case VAR_OBJECTANIMATION:
+        case VAR_OBJECTPREVANIMATION:
+        case VAR_OBJECTANIMATIONSPEED:
+        case VAR_OBJECTANIMATIONTIMER:
+        case VAR_OBJECTVALUE0:
+        case VAR_OBJECTVALUE1:
+        case VAR_OBJECTVALUE2:
+        case VAR_OBJECTVALUE3:
+        case VAR_OBJECTVALUE4:
+        case VAR_OBJECTVALUE5:
+        case VAR_OBJECTVALUE6:
+        case VAR_OBJECTVALUE7: return true;
+    }
+}
+
+// How many leading operands the opcode overwrites without reading, -1 if it can't run isolated
+int GetIsolatedOpcodeOutputs(int opcode)
+{
+    switch (opcode) {
+        default: return -1;
+        case FUNC_EQUAL:
+        case FUNC_SIN:
+        case FUNC_COS:
+        case FUNC_SIN256:
+        case FUNC_COS256:
+        case FUNC_SINCHANGE:
+        case FUNC_COSCHANGE:
+        case FUNC_ATAN2:
+        case FUNC_INTERPOLATE: return 1;
+        case FUNC_INTERPOLATEXY: return 2;
+
+        case FUNC_END:
+        case FUNC_ADD:
+        case FUNC_SUB:
+        case FUNC_INC:
+        case FUNC_DEC:
+        case FUNC_MUL:
+        case FUNC_DIV:
+        case FUNC_SHR:
+        case FUNC_SHL:
+        case FUNC_AND:
+        case FUNC_OR:
+        case FUNC_XOR:
+        case FUNC_MOD:
+        case FUNC_FLIPSIGN:
+        case FUNC_CHECKEQUAL:
+        case FUNC_CHECKGREATER:
+        case FUNC_CHECKLOWER:
+        case FUNC_CHECKNOTEQUAL:
+        case FUNC_IFEQUAL:
+        case FUNC_IFGREATER:
+        case FUNC_IFGREATEROREQUAL:
+        case FUNC_IFLOWER:
+        case FUNC_IFLOWEROREQUAL:
+        case FUNC_IFNOTEQUAL:
+        case FUNC_ELSE:
+        case FUNC_ENDIF:
+        case FUNC_WEQUAL:
+        case FUNC_WGREATER:
+        case FUNC_WGREATEROREQUAL:
+        case FUNC_WLOWER:
+        case FUNC_WLOWEROREQUAL:
+        case FUNC_WNOTEQUAL:
+        case FUNC_LOOP:
+        case FUNC_SWITCH:
+        case FUNC_BREAK:
+        case FUNC_ENDSWITCH:
+        case FUNC_CALLFUNCTION:
+        case FUNC_ENDFUNCTION: return 0;
+    }
+}
+
+// Opcodes that write their variable operands back once they're done, the same ones ProcessScript leaves opcodeSize set for
+inline bool IsolatedOpcodeWritesBack(int opcode)
+{
+    switch (opcode) {
+        default: return opcode >= FUNC_EQUAL && opcode <= FUNC_FLIPSIGN;
+        case FUNC_SIN:
+        case FUNC_COS:
+        case FUNC_SIN256:
+        case FUNC_COS256:
+        case FUNC_SINCHANGE:
+        case FUNC_COSCHANGE:
+        case FUNC_ATAN2:
+        case FUNC_INTERPOLATE:
+        case FUNC_INTERPOLATEXY: return true;
+    }
+}
+
+inline int GetIsolatedTarget(const ScriptRoutineInfo *info, int jumpTableStart, int entry)
+{
+    return (int)(std::lower_bound(info->offsets.begin(), info->offsets.end(), jumpTable[jumpTableStart + entry]) - info->offsets.begin());
+}
 
-        for (int s = 0; s < scriptCount; ++s) {
-            ObjectScript *script = &objectScriptList[scriptID + s];
+bool CompileIsolatedRoutine(const ScriptPtr *ptr, bool function, IsolatedRoutine *routine);
 
-            FileRead(&fileBuffer, 1);
-            script->subMain.jumpTablePtr = fileBuffer;
-            FileRead(&fileBuffer, 1);
-            script->subMain.jumpTablePtr |= fileBuffer << 8;
-            FileRead(&fileBuffer, 1);
-            script->subMain.jumpTablePtr |= fileBuffer << 16;
-            FileRead(&fileBuffer, 1);
-            script->subMain.jumpTablePtr |= fileBuffer << 24;
+IsolatedRoutine *GetIsolatedFunction(int id)
+{
+    IsolatedRoutine *routine = &isolatedFunctions[id];
+    if (routine->status == ISOLATED_UNKNOWN) {
+        routine->status = ISOLATED_SCANNING; // recursion isn't followed
+        routine->status = CompileIsolatedRoutine(&scriptFunctionList[id].ptr, true, routine) ? ISOLATED_VALID : ISOLATED_INVALID;
+    }
+    return routine->status == ISOLATED_VALID ? routine : nullptr;
+}
 
-            FileRead(&fileBuffer, 1);
-            script->subPlayerInteraction.jumpTablePtr = fileBuffer;
-            FileRead(&fileBuffer, 1);
-            script->subPlayerInteraction.jumpTablePtr |= fileBuffer << 8;
-            FileRead(&fileBuffer, 1);
-            script->subPlayerInteraction.jumpTablePtr |= fileBuffer << 16;
-            FileRead(&fileBuffer, 1);
-            script->subPlayerInteraction.jumpTablePtr |= fileBuffer << 24;
+bool CompileIsolatedRoutine(const ScriptPtr *ptr, bool function, IsolatedRoutine *routine)
+{
+    routine->code.clear();
+    routine->cases.clear();
+    routine->inputs  = ISOLATED_REG_ALL;
+    routine->outputs = 0;
 
-            FileRead(&fileBuffer, 1);
-            script->subDraw.jumpTablePtr = fileBuffer;
-            FileRead(&fileBuffer, 1);
-            script->subDraw.jumpTablePtr |= fileBuffer << 8;
-            FileRead(&fileBuffer, 1);
-            script->subDraw.jumpTablePtr |= fileBuffer << 16;
-            FileRead(&fileBuffer, 1);
-            script->subDraw.jumpTablePtr |= fileBuffer << 24;
+    ScriptRoutineInfo info;
+    if (ptr->scriptCodePtr >= scriptCodePos || !ScanScriptRoutine(ptr->scriptCodePtr, ptr->jumpTablePtr, function, &info))
+        return false;
 
-            FileRead(&fileBuffer, 1);
-            script->subStartup.jumpTablePtr = fileBuffer;
-            FileRead(&fileBuffer, 1);
-            script->subStartup.jumpTablePtr |= fileBuffer << 8;
-            FileRead(&fileBuffer, 1);
-            script->subStartup.jumpTablePtr |= fileBuffer << 16;
-            FileRead(&fileBuffer, 1);
-            script->subStartup.jumpTablePtr |= fileBuffer << 24;
+    int count = (int)info.offsets.size();
+    std::vector<int> uses(count), defs(count);
+    routine->code.resize(count);
+    for (int i = 0; i < count; ++i) {
+        ScriptInstructionInfo ins;
+        DecodeScriptInstruction(ptr->scriptCodePtr + info.offsets[i], &ins);
+
+        int outputs = GetIsolatedOpcodeOutputs(ins.opcode);
+        if (outputs < 0)
+            return false;
+
+        IsolatedInstruction *code = &routine->code[i];
+        code->opcode              = ins.opcode;
+        code->operandCount        = ins.operandCount;
+        code->target              = -1;
+        for (int o = 0; o < ins.operandCount; ++o) {
+            const ScriptOperandInfo *op = &ins.operands[o];
+            if (!IsIsolatedOperand(op))
+                return false;
+
+            code->operands[o].variable = op->type == SCRIPTVAR_VAR ? op->variable : ISOLATED_CONSTANT;
+            code->operands[o].value    = op->type == SCRIPTVAR_INTCONST ? op->value : 0;
+            if (op->type == SCRIPTVAR_VAR) {
+                int reg = GetIsolatedRegister(op->variable);
+                if (o >= outputs)
+                    uses[i] |= reg;
+                if (IsolatedOpcodeWritesBack(ins.opcode))
+                    defs[i] |= reg;
+            }
         }
 
-        FileRead(&fileBuffer, 1);
-        int functionCount = fileBuffer;
-        FileRead(&fileBuffer, 1);
-        functionCount |= fileBuffer << 8;
+        int entry = ins.operandCount ? ins.operands[0].value : 0;
+        int block = info.blocks[i];
+        switch (ins.opcode) {
+            default: break;
+            case FUNC_CHECKEQUAL:
+            case FUNC_CHECKGREATER:
+            case FUNC_CHECKLOWER:
+            case FUNC_CHECKNOTEQUAL: defs[i] |= ISOLATED_REG_CHECKRESULT; break;
 
-        for (int f = 0; f < functionCount; ++f) {
-            ScriptFunction *function = &scriptFunctionList[f];
+            case FUNC_IFEQUAL:
+            case FUNC_IFGREATER:
+            case FUNC_IFGREATEROREQUAL:
+            case FUNC_IFLOWER:
+            case FUNC_IFLOWEROREQUAL:
+            case FUNC_IFNOTEQUAL: code->target = GetIsolatedTarget(&info, ptr->jumpTablePtr, entry); break;
 
-            FileRead(&fileBuffer, 1);
-            function->ptr.scriptCodePtr = fileBuffer;
-            FileRead(&fileBuffer, 1);
-            function->ptr.scriptCodePtr |= fileBuffer << 8;
-            FileRead(&fileBuffer, 1);
-            function->ptr.scriptCodePtr |= fileBuffer << 16;
-            FileRead(&fileBuffer, 1);
-            function->ptr.scriptCodePtr |= fileBuffer << 24;
+            case FUNC_WEQUAL:
+            case FUNC_WGREATER:
+            case FUNC_WGREATEROREQUAL:
+            case FUNC_WLOWER:
+            case FUNC_WLOWEROREQUAL:
+            case FUNC_WNOTEQUAL: code->target = GetIsolatedTarget(&info, ptr->jumpTablePtr, entry + 1); break;
+
+            case FUNC_ELSE: code->target = GetIsolatedTarget(&info, ptr->jumpTablePtr, block + 1); break;
+            case FUNC_LOOP: code->target = GetIsolatedTarget(&info, ptr->jumpTablePtr, block); break;
+            case FUNC_BREAK: code->target = GetIsolatedTarget(&info, ptr->jumpTablePtr, block + 3); break;
+
+            case FUNC_SWITCH: {
+                int low      = jumpTable[ptr->jumpTablePtr + entry];
+                int high     = jumpTable[ptr->jumpTablePtr + entry + 1];
+                code->target = (int)routine->cases.size();
+                routine->cases.push_back(low);
+                routine->cases.push_back(high);
+                routine->cases.push_back(GetIsolatedTarget(&info, ptr->jumpTablePtr, entry + 2));
+                for (int c = 0; c <= high - low; ++c) routine->cases.push_back(GetIsolatedTarget(&info, ptr->jumpTablePtr, entry + 4 + c));
+                break;
+            }
+
+            case FUNC_CALLFUNCTION: {
+                IsolatedRoutine *callee = GetIsolatedFunction(entry);
+                if (!callee)
+                    return false;
+                uses[i] |= callee->inputs;
+                defs[i] |= callee->outputs;
+                break;
+            }
         }
+    }
 
-        for (int f = 0; f < functionCount; ++f) {
-            ScriptFunction *function = &scriptFunctionList[f];
+    // forward "written on every path" pass, a register used where it isn't is an input
+    std::vector<int> written(count, ISOLATED_REG_ALL);
+    std::vector<bool> reached(count, false);
+    std::vector<int> queue;
+    written[0] = 0;
+    reached[0] = true;
+    queue.push_back(0);
+    while (!queue.empty()) {
+        int i = queue.back();
+        queue.pop_back();
+
+        const IsolatedInstruction *code = &routine->code[i];
+        int out                         = written[i] | defs[i];
+        int next[2]                     = { i + 1, code->target };
+        int nextCount                   = 1;
+        const int *targets              = next;
+        switch (code->opcode) {
+            case FUNC_END:
+            case FUNC_ENDFUNCTION: nextCount = 0; break;
+            case FUNC_ELSE:
+            case FUNC_LOOP:
+            case FUNC_BREAK: targets = &next[1]; break;
+            case FUNC_SWITCH: // the default then every case
+                targets   = &routine->cases[code->target + 2];
+                nextCount = routine->cases[code->target + 1] - routine->cases[code->target] + 2;
+                break;
+            default:
+                if (code->target >= 0)
+                    nextCount = 2;
+                break;
+        }
 
-            FileRead(&fileBuffer, 1);
-            function->ptr.jumpTablePtr = fileBuffer;
-            FileRead(&fileBuffer, 1);
-            function->ptr.jumpTablePtr |= fileBuffer << 8;
-            FileRead(&fileBuffer, 1);
-            function->ptr.jumpTablePtr |= fileBuffer << 16;
-            FileRead(&fileBuffer, 1);
-            function->ptr.jumpTablePtr |= fileBuffer << 24;
+        for (int n = 0; n < nextCount; ++n) {
+            int s = targets[n];
+            if (s >= count)
+                continue;
+            if (!reached[s] || (written[s] & out) != written[s]) {
+                written[s] &= out;
+                reached[s] = true;
+                queue.push_back(s);
+            }
         }
+    }
 
-        CloseFile();
+    routine->inputs  = 0;
+    routine->outputs = ISOLATED_REG_ALL;
+    for (int i = 0; i < count; ++i) {
+        if (!reached[i])
+            continue;
+        routine->inputs |= uses[i] & ~written[i];
+        if (routine->code[i].opcode == FUNC_ENDFUNCTION)
+            routine->outputs &= written[i] | defs[i];
     }
+    return true;
 }
 
-void ClearScriptData()
+void ClassifyIsolatedObjects()
 {
-    memset(scriptCode, 0, SCRIPTDATA_COUNT * sizeof(int));
-    memset(jumpTable, 0, JUMPTABLE_COUNT * sizeof(int));
+    memset(isolatedObjectTypes, 0, sizeof(isolatedObjectTypes));
+    for (int f = 0; f < FUNCTION_COUNT; ++f) {
+        isolatedFunctions[f].code.clear();
+        isolatedFunctions[f].cases.clear();
+        isolatedFunctions[f].status = ISOLATED_UNKNOWN;
+    }
 
-    scriptFrameCount = 0;
+    int typeCount     = 0;
+    int isolatedCount = 0;
+    for (int t = OBJ_TYPE_BLANKOBJECT + 1; t < OBJECT_COUNT; ++t) {
+        ObjectScript *scriptInfo = &objectScriptList[t];
+        IsolatedRoutine *routine = &isolatedMainSubs[t];
+        routine->code.clear();
+        routine->cases.clear();
+        if (scriptInfo->subMain.scriptCodePtr >= scriptCodePos || scriptCode[scriptInfo->subMain.scriptCodePtr] <= 0)
+            continue;
+
+        ++typeCount;
+        isolatedObjectTypes[t] = scriptCode[scriptInfo->subPlayerInteraction.scriptCodePtr] <= 0
+                                 && CompileIsolatedRoutine(&scriptInfo->subMain, false, routine) && !routine->inputs;
+        if (isolatedObjectTypes[t]) {
+            ++isolatedCount;
+            PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_DEBUG, "%s updates in isolation", typeNames[t]);
+        }
+        else {
+            routine->code.clear();
+            routine->cases.clear();
+        }
+    }
+    PrintLogCategory(LOGCAT_SCRIPT, LOGLEVEL_INFO, "%d of %d object types can update on the object workers", isolatedCount, typeCount);
+}
 
-    scriptCodePos     = 0;
-    jumpTablePos      = 0;
-    jumpTableStackPos = 0;
-    functionStackPos  = 0;
+inline int ReadIsolatedOperand(const IsolatedOperand *op, int slot, const ScriptEngine *state)
+{
+    Entity *entity = &objectEntityList[slot];
+    switch (op->variable) {
+        default:
+        case ISOLATED_CONSTANT: return op->value;
+        case VAR_TEMPVALUE0:
+        case VAR_TEMPVALUE1:
+        case VAR_TEMPVALUE2:
+        case VAR_TEMPVALUE3:
+        case VAR_TEMPVALUE4:
+        case VAR_TEMPVALUE5:
+        case VAR_TEMPVALUE6:
+        case VAR_TEMPVALUE7: return state->tempValue[op->variable - VAR_TEMPVALUE0];
+        case VAR_CHECKRESULT: return state->checkResult;
+        case VAR_ARRAYPOS0: return state->arrayPosition[0];
+        case VAR_ARRAYPOS1: return state->arrayPosition[1];
+        case VAR_OBJECTENTITYNO: return slot;
+        case VAR_OBJECTTYPE: return entity->type;
+        case VAR_OBJECTPROPERTYVALUE: return entity->propertyValue;
+        case VAR_OBJECTXPOS: return entity->XPos;
+        case VAR_OBJECTYPOS: return entity->YPos;
+        case VAR_OBJECTIXPOS: return entity->XPos >> 16;
+        case VAR_OBJECTIYPOS: return entity->YPos >> 16;
+        case VAR_OBJECTSTATE: return entity->state;
+        case VAR_OBJECTROTATION: return entity->rotation;
+        case VAR_OBJECTSCALE: return entity->scale;
+        case VAR_OBJECTPRIORITY: return entity->priority;
+        case VAR_OBJECTDRAWORDER: return entity->drawOrder;
+        case VAR_OBJECTDIRECTION: return entity->direction;
+        case VAR_OBJECTINKEFFECT: return entity->inkEffect;
+        case VAR_OBJECTALPHA: return entity->alpha;
+        case VAR_OBJECTFRAME: return entity->frame;
+        case VAR_OBJECTANIMATION: return entity->animation;
+        case VAR_OBJECTPREVANIMATION: return entity->prevAnimation;
+        case VAR_OBJECTANIMATIONSPEED: return entity->animationSpeed;
+        case VAR_OBJECTANIMATIONTIMER: return entity->animationTimer;
+        case VAR_OBJECTVALUE0:
+        case VAR_OBJECTVALUE1:
+        case VAR_OBJECTVALUE2:
+        case VAR_OBJECTVALUE3:
+        case VAR_OBJECTVALUE4:
+        case VAR_OBJECTVALUE5:
+        case VAR_OBJECTVALUE6:
+        case VAR_OBJECTVALUE7: return entity->values[op->variable - VAR_OBJECTVALUE0];
+    }
+}
 
-    scriptCodePos    = 0;
-    scriptCodeOffset = 0;
-    jumpTablePos     = 0;
-    jumpTableOffset  = 0;
+inline void WriteIsolatedOperand(const IsolatedOperand *op, int slot, int value, IsolatedScriptResult *result)
+{
+    Entity *entity = &objectEntityList[slot];
+    result->written |= GetIsolatedRegister(op->variable);
+    switch (op->variable) {
+        default: break;
+        case VAR_TEMPVALUE0:
+        case VAR_TEMPVALUE1:
+        case VAR_TEMPVALUE2:
+        case VAR_TEMPVALUE3:
+        case VAR_TEMPVALUE4:
+        case VAR_TEMPVALUE5:
+        case VAR_TEMPVALUE6:
+        case VAR_TEMPVALUE7: result->state.tempValue[op->variable - VAR_TEMPVALUE0] = value; break;
+        case VAR_CHECKRESULT: result->state.checkResult = value; break;
+        case VAR_ARRAYPOS0: result->state.arrayPosition[0] = value; break;
+        case VAR_ARRAYPOS1: result->state.arrayPosition[1] = value; break;
+        case VAR_OBJECTTYPE: entity->type = value; break;
+        case VAR_OBJECTPROPERTYVALUE: entity->propertyValue = value; break;
+        case VAR_OBJECTXPOS: entity->XPos = value; break;
+        case VAR_OBJECTYPOS: entity->YPos = value; break;
+        case VAR_OBJECTIXPOS: entity->XPos = value << 16; break;
+        case VAR_OBJECTIYPOS: entity->YPos = value << 16; break;
+        case VAR_OBJECTSTATE: entity->state = value; break;
+        case VAR_OBJECTROTATION: entity->rotation = value; break;
+        case VAR_OBJECTSCALE: entity->scale = value; break;
+        case VAR_OBJECTPRIORITY: entity->priority = value; break;
+        case VAR_OBJECTDRAWORDER: entity->drawOrder = value; break;
+        case VAR_OBJECTDIRECTION: entity->direction = value; break;
+        case VAR_OBJECTINKEFFECT: entity->inkEffect = value; break;
+        case VAR_OBJECTALPHA: entity->alpha = value; break;
+        case VAR_OBJECTFRAME: entity->frame = value; break;
+        case VAR_OBJECTANIMATION: entity->animation = value; break;
+        case VAR_OBJECTPREVANIMATION: entity->prevAnimation = value; break;
+        case VAR_OBJECTANIMATIONSPEED: entity->animationSpeed = value; break;
+        case VAR_OBJECTANIMATIONTIMER: entity->animationTimer = value; break;
+        case VAR_OBJECTVALUE0:
+        case VAR_OBJECTVALUE1:
+        case VAR_OBJECTVALUE2:
+        case VAR_OBJECTVALUE3:
+        case VAR_OBJECTVALUE4:
+        case VAR_OBJECTVALUE5:
+        case VAR_OBJECTVALUE6:
+        case VAR_OBJECTVALUE7: entity->values[op->variable - VAR_OBJECTVALUE0] = value; break;
+    }
+}
 
-#if RETRO_USE_COMPILER
-    scriptFunctionCount = 0;
-#endif
+// Mirrors ProcessScript for the opcodes GetIsolatedOpcodeOutputs allows, returns true if the routine hit End
+bool RunIsolatedRoutine(const IsolatedRoutine *routine, int slot, IsolatedScriptResult *result)
+{
+    int *operands = result->state.operands;
+    int pc        = 0;
+    while (true) {
+        const IsolatedInstruction *ins = &routine->code[pc++];
+        for (int i = 0; i < ins->operandCount; ++i) operands[i] = ReadIsolatedOperand(&ins->operands[i], slot, &result->state);
+        if (ins->operandCount > result->operandCount)
+            result->operandCount = ins->operandCount;
 
-    aliasCount = COMMONALIAS_COUNT;
-    lineID     = 0;
+        switch (ins->opcode) {
+            default: break;
+            case FUNC_END: return true;
+            case FUNC_ENDFUNCTION: return false;
+            case FUNC_EQUAL: operands[0] = operands[1]; break;
+            case FUNC_ADD: operands[0] += operands[1]; break;
+            case FUNC_SUB: operands[0] -= operands[1]; break;
+            case FUNC_INC: ++operands[0]; break;
+            case FUNC_DEC: --operands[0]; break;
+            case FUNC_MUL: operands[0] *= operands[1]; break;
+            case FUNC_DIV: operands[0] /= operands[1]; break;
+            case FUNC_SHR: operands[0] >>= operands[1]; break;
+            case FUNC_SHL: operands[0] <<= operands[1]; break;
+            case FUNC_AND: operands[0] &= operands[1]; break;
+            case FUNC_OR: operands[0] |= operands[1]; break;
+            case FUNC_XOR: operands[0] ^= operands[1]; break;
+            case FUNC_MOD: operands[0] %= operands[1]; break;
+            case FUNC_FLIPSIGN: operands[0] = -operands[0]; break;
+            case FUNC_CHECKEQUAL:
+                result->state.checkResult = operands[0] == operands[1];
+                result->written |= ISOLATED_REG_CHECKRESULT;
+                break;
+            case FUNC_CHECKGREATER:
+                result->state.checkResult = operands[0] > operands[1];
+                result->written |= ISOLATED_REG_CHECKRESULT;
+                break;
+            case FUNC_CHECKLOWER:
+                result->state.checkResult = operands[0] < operands[1];
+                result->written |= ISOLATED_REG_CHECKRESULT;
+                break;
+            case FUNC_CHECKNOTEQUAL:
+                result->state.checkResult = operands[0] != operands[1];
+                result->written |= ISOLATED_REG_CHECKRESULT;
+                break;
 
-    ClearGraphicsData();
-    ClearAnimationData();
+            case FUNC_IFEQUAL:
+            case FUNC_WEQUAL:
+                if (operands[1] != operands[2])
+                    pc = ins->target;
+                break;
+            case FUNC_IFGREATER:
+            case FUNC_WGREATER:
+                if (operands[1] <= operands[2])
+                    pc = ins->target;
+                break;
+            case FUNC_IFGREATEROREQUAL:
+            case FUNC_WGREATEROREQUAL:
+                if (operands[1] < operands[2])
+                    pc = ins->target;
+                break;
+            case FUNC_IFLOWER:
+            case FUNC_WLOWER:
+                if (operands[1] >= operands[2])
+                    pc = ins->target;
+                break;
+            case FUNC_IFLOWEROREQUAL:
+            case FUNC_WLOWEROREQUAL:
+                if (operands[1] > operands[2])
+                    pc = ins->target;
+                break;
+            case FUNC_IFNOTEQUAL:
+            case FUNC_WNOTEQUAL:
+                if (operands[1] == operands[2])
+                    pc = ins->target;
+                break;
+            case FUNC_ELSE:
+            case FUNC_LOOP:
+            case FUNC_BREAK: pc = ins->target; break;
+            case FUNC_SWITCH: {
+                const int *cases = &routine->cases[ins->target];
+                if (operands[1] < cases[0] || operands[1] > cases[1])
+                    pc = cases[2];
+                else
+                    pc = cases[3 + operands[1] - cases[0]];
+                break;
+            }
 
-    for (int p = 0; p < PLAYER_COUNT; ++p) {
-        playerList[p].animationFile = GetDefaultAnimationRef();
-        playerList[p].boundEntity   = &objectEntityList[p];
-    }
+            case FUNC_SIN: operands[0] = Sin512(operands[1]); break;
+            case FUNC_COS: operands[0] = Cos512(operands[1]); break;
+            case FUNC_SIN256: operands[0] = Sin256(operands[1]); break;
+            case FUNC_COS256: operands[0] = Cos256(operands[1]); break;
+            case FUNC_SINCHANGE: operands[0] = operands[3] + (Sin512(operands[1]) >> operands[2]) - operands[4]; break;
+            case FUNC_COSCHANGE: operands[0] = operands[3] + (Cos512(operands[1]) >> operands[2]) - operands[4]; break;
+            case FUNC_ATAN2: operands[0] = ArcTanLookup(operands[1], operands[2]); break;
+            case FUNC_INTERPOLATE: operands[0] = (operands[2] * (0x100 - operands[3]) + operands[3] * operands[1]) >> 8; break;
+            case FUNC_INTERPOLATEXY:
+                operands[0] = (operands[3] * (0x100 - operands[6]) >> 8) + ((operands[6] * operands[2]) >> 8);
+                operands[1] = (operands[5] * (0x100 - operands[6]) >> 8) + (operands[6] * operands[4] >> 8);
+                break;
 
-    for (int o = 0; o < OBJECT_COUNT; ++o) {
-        ObjectScript *scriptInfo                       = &objectScriptList[o];
-        scriptInfo->subMain.scriptCodePtr              = SCRIPTDATA_COUNT - 1;
-        scriptInfo->subMain.jumpTablePtr               = JUMPTABLE_COUNT - 1;
-        scriptInfo->subPlayerInteraction.scriptCodePtr = SCRIPTDATA_COUNT - 1;
-        scriptInfo->subPlayerInteraction.jumpTablePtr  = JUMPTABLE_COUNT - 1;
-        scriptInfo->subDraw.scriptCodePtr              = SCRIPTDATA_COUNT - 1;
-        scriptInfo->subDraw.jumpTablePtr               = JUMPTABLE_COUNT - 1;
-        scriptInfo->subStartup.scriptCodePtr           = SCRIPTDATA_COUNT - 1;
-        scriptInfo->subStartup.jumpTablePtr            = JUMPTABLE_COUNT - 1;
-        scriptInfo->frameListOffset                    = 0;
-        scriptInfo->spriteSheetID                      = 0;
-        scriptInfo->animFile                           = GetDefaultAnimationRef();
-        scriptInfo->mobile                             = true;
-        typeNames[o][0]                                = 0;
-    }
+            case FUNC_CALLFUNCTION:
+                if (RunIsolatedRoutine(&isolatedFunctions[operands[0]], slot, result))
+                    return true;
+                break;
+        }
 
-    for (int f = 0; f < FUNCTION_COUNT; ++f) {
-        scriptFunctionList[f].ptr.scriptCodePtr = SCRIPTDATA_COUNT - 1;
-        scriptFunctionList[f].ptr.jumpTablePtr  = JUMPTABLE_COUNT - 1;
+        if (IsolatedOpcodeWritesBack(ins->opcode)) {
+            for (int i = 0; i < ins->operandCount; ++i) {
+                if (ins->operands[i].variable != ISOLATED_CONSTANT)
+                    WriteIsolatedOperand(&ins->operands[i], slot, operands[i], result);
+            }
+        }
     }
+}
 
-    SetObjectTypeName((char *)"Blank Object", 0);
+// Safe to call from the object workers, everything it writes belongs to the entity in the slot or to the result
+void RunIsolatedObject(int slot, IsolatedScriptResult *result)
+{
+    memset(result, 0, sizeof(IsolatedScriptResult));
+    RunIsolatedRoutine(&isolatedMainSubs[objectEntityList[slot].type], slot, result);
+    SyncEntityHotFields(slot);
+}
 
-    for (int s = 0; s < COLSTORE_COUNT; s++) {
-        collisionStorage[s].entityNo = -1;
-        collisionStorage[s].type     = -1;
-        collisionStorage[s].left     = 0;
-        collisionStorage[s].top      = 0;
-        collisionStorage[s].right    = 0;
-        collisionStorage[s].bottom   = 0;
+// Applies a run's register writes to scriptEng, called in entity order so the registers end up as a serial update leaves them
+void MergeIsolatedScriptState(const IsolatedScriptResult *result)
+{
+    for (int i = 0; i < result->operandCount; ++i) scriptEng.operands[i] = result->state.operands[i];
+    for (int t = 0; t < 8; ++t) {
+        if (result->written & (1 << t))
+            scriptEng.tempValue[t] = result->state.tempValue[t];
+    }
+    if (result->written & ISOLATED_REG_CHECKRESULT)
+        scriptEng.checkResult = result->state.checkResult;
+    for (int p = 0; p < 2; ++p) {
+        if (result->written & (ISOLATED_REG_CHECKRESULT << (1 + p)))
+            scriptEng.arrayPosition[p] = result->state.arrayPosition[p];
     }
-
 }
+#endif
 
 void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
 {
@@ -2187,6 +4175,17 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
 
     jumpTableStackPos = 0;
     functionStackPos  = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+    int stepMode   = scriptStepMode;
+    scriptStepMode = SCRIPTSTEP_NONE;
+    if (!stepMode && Engine.useNativeScripts && !(objectReferencePass && Engine.verifyNativeScripts) && !nativeSubBindings.empty()) {
+        NativeScript native = FindNativeScript(scriptCodeStart);
+        if (native) {
+            native(scriptCodeStart, scriptSub);
+            return;
+        }
+    }
+#endif
     while (running) {
         int opcode           = scriptCode[scriptCodePtr++];
         int opcodeSize       = functions[opcode].opcodeSize;
@@ -2856,6 +4855,11 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
             }
         }
 
+#if !RETRO_USE_ORIGINAL_CODE
+        if (stepMode == SCRIPTSTEP_OPERANDS)
+            break;
+#endif
+
         ObjectScript *scriptInfo = &objectScriptList[objectEntityList[objectLoop].type];
         Entity *entity           = &objectEntityList[objectLoop];
         Player *player           = &playerList[activePlayer];
@@ -3565,6 +5569,9 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
                 newEnt->values[5]     = 0;
                 newEnt->values[6]     = 0;
                 newEnt->values[7]     = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+                SyncEntityHotFields(scriptEng.operands[0]);
+#endif
                 break;
             }
             case FUNC_PLAYEROBJECTCOLLISION:
@@ -3640,6 +5647,9 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
                 temp->values[5]      = 0;
                 temp->values[6]      = 0;
                 temp->values[7]      = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+                SyncEntityHotFields(scriptEng.arrayPosition[2]);
+#endif
                 break;
             }
             case FUNC_BINDPLAYERTOOBJECT: {
@@ -3965,6 +5975,18 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
                 AnimationFile *animFile = scriptInfo->animFile;
                 scriptEng.operands[0]   = -1;
                 int id                  = 0;
+#if !RETRO_USE_ORIGINAL_CODE
+                // names that were never interned, or animations that couldn't get a symbol once the table was full, fall back
+                // to the string search
+                int nameSymbol = FindSymbol(scriptText);
+                if (nameSymbol != SYMBOL_NONE) {
+                    for (; id < animFile->animCount && scriptEng.operands[0] == -1; ++id) {
+                        if (SymbolMatch(animationList[animFile->aniListOffset + id].nameSymbol, nameSymbol))
+                            scriptEng.operands[0] = id;
+                    }
+                    id = 0;
+                }
+#endif
                 while (scriptEng.operands[0] == -1) {
                     SpriteAnimation *anim = &animationList[animFile->aniListOffset + id];
                     if (StrComp(scriptText, anim->name))
@@ -4098,6 +6120,9 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
                     case VAR_OBJECTENTITYNO: break;
                     case VAR_OBJECTTYPE: {
                         objectEntityList[arrayVal].type = scriptEng.operands[i];
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(arrayVal);
+#endif
                         break;
                     }
                     case VAR_OBJECTPROPERTYVALUE: {
@@ -4106,18 +6131,30 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
                     }
                     case VAR_OBJECTXPOS: {
                         objectEntityList[arrayVal].XPos = scriptEng.operands[i];
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(arrayVal);
+#endif
                         break;
                     }
                     case VAR_OBJECTYPOS: {
                         objectEntityList[arrayVal].YPos = scriptEng.operands[i];
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(arrayVal);
+#endif
                         break;
                     }
                     case VAR_OBJECTIXPOS: {
                         objectEntityList[arrayVal].XPos = scriptEng.operands[i] << 16;
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(arrayVal);
+#endif
                         break;
                     }
                     case VAR_OBJECTIYPOS: {
                         objectEntityList[arrayVal].YPos = scriptEng.operands[i] << 16;
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(arrayVal);
+#endif
                         break;
                     }
                     case VAR_OBJECTSTATE: {
@@ -4134,10 +6171,16 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
                     }
                     case VAR_OBJECTPRIORITY: {
                         objectEntityList[arrayVal].priority = scriptEng.operands[i];
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(arrayVal);
+#endif
                         break;
                     }
                     case VAR_OBJECTDRAWORDER: {
                         objectEntityList[arrayVal].drawOrder = scriptEng.operands[i];
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(arrayVal);
+#endif
                         break;
                     }
                     case VAR_OBJECTDIRECTION: {
@@ -4392,10 +6435,16 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
                     }
                     case VAR_PLAYERPRIORITY: {
                         scriptEng.operands[i] = playerList[activePlayer].boundEntity->priority = scriptEng.operands[i];
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(playerList[activePlayer].entityNo);
+#endif
                         break;
                     }
                     case VAR_PLAYERDRAWORDER: {
                         scriptEng.operands[i] = playerList[activePlayer].boundEntity->drawOrder = scriptEng.operands[i];
+#if !RETRO_USE_ORIGINAL_CODE
+                        SyncEntityHotFields(playerList[activePlayer].entityNo);
+#endif
                         break;
                     }
                     case VAR_PLAYERDIRECTION: {
@@ -4685,5 +6734,10 @@ void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub)
                 scriptCodePtr++;
             }
         }
+
+#if !RETRO_USE_ORIGINAL_CODE
+        if (stepMode)
+            break;
+#endif
     }
 }
@@ -10,6 +10,13 @@
 
 #define RETRO_USE_COMPILER (1)
 
+#if !RETRO_USE_ORIGINAL_CODE
+// Set to (1) once a NativeScripts.hpp written by the "scriptaot=" tool mode has been placed next to Script.cpp
+#ifndef RETRO_USE_NATIVE_SCRIPTS
+#define RETRO_USE_NATIVE_SCRIPTS (0)
+#endif
+#endif
+
 struct ScriptPtr {
     int scriptCodePtr;
     int jumpTablePtr;
@@ -51,7 +58,7 @@ extern ScriptFunction scriptFunctionList[FUNCTION_COUNT];
 extern int scriptFunctionCount;
 
 extern int scriptCode[SCRIPTDATA_COUNT];
-extern int jumpTableData[JUMPTABLE_COUNT];
+extern int jumpTable[JUMPTABLE_COUNT];
 
 extern int jumpTableStack[JUMPSTACK_COUNT];
 extern int functionStack[FUNCSTACK_COUNT];
@@ -87,11 +94,45 @@ void CopyAliasStr(char *dest, char *text, bool arrayIndex);
 bool CheckOpcodeType(char *text); // Never actually used
 
 void ParseScriptFile(char *scriptName, int scriptID);
+#if !RETRO_USE_ORIGINAL_CODE
+void InvalidateTypeNameIndex();
+#endif
 #endif
 void LoadBytecode(int stageListID, int scriptID);
 
 void ProcessScript(int scriptCodeStart, int jumpTableStart, byte scriptSub);
 
+#if !RETRO_USE_ORIGINAL_CODE
+// Script routines translated to C++ ahead of time, returns true if the routine hit an End opcode
+typedef bool (*NativeScript)(int scriptCodeStart, byte scriptSub);
+
+struct NativeScriptEntry {
+    unsigned long long hash;
+    NativeScript script;
+};
+
+extern NativeScript nativeFunctionList[FUNCTION_COUNT];
+
+void RunScriptInstruction(int scriptCodePtr, byte scriptSub);
+void ReadScriptOperands(int scriptCodePtr, byte scriptSub);
+void BindNativeScripts();
+NativeScript FindNativeScript(int scriptCodePtr);
+int TranslateScriptBytecode(const char *outputPath);
+
+// Script registers one isolated object run wrote, kept apart so the runs can happen on the object workers
+struct IsolatedScriptResult {
+    ScriptEngine state;
+    int written;
+    int operandCount;
+};
+
+extern bool isolatedObjectTypes[OBJECT_COUNT];
+
+void ClassifyIsolatedObjects();
+void RunIsolatedObject(int slot, IsolatedScriptResult *result);
+void MergeIsolatedScriptState(const IsolatedScriptResult *result);
+#endif
+
 void ClearScriptData();
 
 #endif // !SCRIPT_H
@@ -244,6 +244,9 @@ void RemoveGraphicsFile(const char *filePath, int sheetID)
 
     if (sheetID >= 0 && StrLength(gfxSurface[sheetID].fileName)) {
         StrCopy(gfxSurface[sheetID].fileName, "");
+#if !RETRO_USE_ORIGINAL_CODE
+        gfxSurface[sheetID].fileSymbol = SYMBOL_NONE;
+#endif
         int dataPosStart = gfxSurface[sheetID].dataPosition;
         int dataPosEnd   = gfxSurface[sheetID].dataPosition + gfxSurface[sheetID].height * gfxSurface[sheetID].width;
         for (int i = 0x200000 - dataPosEnd; i > 0; --i) graphicData[dataPosStart++] = graphicData[dataPosEnd++];
@@ -261,6 +264,9 @@ int LoadBMPFile(const char *filePath, byte sheetID)
     if (LoadFile(filePath, &info)) {
         GFXSurface *surface = &gfxSurface[sheetID];
         StrCopy(surface->fileName, filePath);
+#if !RETRO_USE_ORIGINAL_CODE
+        surface->fileSymbol = InternSymbol(filePath);
+#endif
 
         byte fileBuffer = 0;
 
@@ -320,6 +326,9 @@ int LoadGIFFile(const char *filePath, byte sheetID)
     if (LoadFile(filePath, &info)) {
         GFXSurface *surface = &gfxSurface[sheetID];
         StrCopy(surface->fileName, filePath);
+#if !RETRO_USE_ORIGINAL_CODE
+        surface->fileSymbol = InternSymbol(filePath);
+#endif
 
         byte fileBuffer = 0;
         byte fileBuffer2[2];
@@ -398,6 +407,9 @@ int LoadGFXFile(const char *filePath, byte sheetID)
     if (LoadFile(filePath, &info)) {
         GFXSurface *surface = &gfxSurface[sheetID];
         StrCopy(surface->fileName, filePath);
+#if !RETRO_USE_ORIGINAL_CODE
+        surface->fileSymbol = InternSymbol(filePath);
+#endif
 
         byte fileBuffer = 0;
         FileRead(&fileBuffer, 1);
@@ -458,6 +470,9 @@ int LoadRSVFile(const char *filePath, byte sheetID)
     if (LoadFile(filePath, &info)) {
         GFXSurface *surface = &gfxSurface[sheetID];
         StrCopy(surface->fileName, filePath);
+#if !RETRO_USE_ORIGINAL_CODE
+        surface->fileSymbol = InternSymbol(filePath);
+#endif
 
         videoSurface      = sheetID;
         currentVideoFrame = 0;
@@ -502,6 +517,9 @@ int LoadPVRFile(const char *filePath, byte sheetID)
     if (LoadFile(filePath, &info)) {
         GFXSurface *surface = &gfxSurface[sheetID];
         StrCopy(surface->fileName, filePath);
+#if !RETRO_USE_ORIGINAL_CODE
+        surface->fileSymbol = InternSymbol(filePath);
+#endif
 
         byte fileBuffer[2];
 
@@ -25,4 +25,102 @@ int FindStringToken(const char *string, const char *token, sbyte stopID)
         ++stringCharID;
     }
     return -1;
-}
\ No newline at end of file
+}
+#if !RETRO_USE_ORIGINAL_CODE
+#define SYMBOL_HASH_SIZE (SYMBOL_COUNT * 2)
+
+int symbolCount             = 1; // SYMBOL_NONE
+int symbolCompareCount      = 0;
+int symbolComparesLastFrame = 0;
+
+ushort symbolHashTable[SYMBOL_HASH_SIZE]; // symbol IDs, 0 is an empty slot
+uint symbolHashes[SYMBOL_COUNT];
+int symbolNameOffsets[SYMBOL_COUNT];
+char symbolPool[SYMBOL_POOL_SIZE];
+int symbolPoolPos = 1; // SYMBOL_NONE's empty name
+
+const char *engineSymbolNames[] = {
+    "Mini_PlayerFlag", "PLAYER_AMY", "ANI_HAMMER_JUMP", "ANI_HAMMER_DASH", "TouchControls", "Data/Sprites/Global/DPad.gif",
+};
+
+void InitSymbolTable()
+{
+    memset(symbolHashTable, 0, sizeof(symbolHashTable));
+    symbolCount   = 1;
+    symbolPoolPos = 1;
+    symbolPool[0] = 0;
+
+    for (int s = 0; s < SYMBOL_ENGINE_COUNT - 1; ++s) InternSymbol(engineSymbolNames[s]);
+}
+
+int LookupSymbol(const char *name, uint hash, int *slot)
+{
+    int pos = hash & (SYMBOL_HASH_SIZE - 1);
+    while (symbolHashTable[pos]) {
+        int symbol = symbolHashTable[pos];
+        if (symbolHashes[symbol] == hash && StrComp(&symbolPool[symbolNameOffsets[symbol]], name))
+            return symbol;
+        pos = (pos + 1) & (SYMBOL_HASH_SIZE - 1);
+    }
+    if (slot)
+        *slot = pos;
+    return SYMBOL_NONE;
+}
+
+int InternSymbol(const char *name)
+{
+    if (!name || !name[0])
+        return SYMBOL_NONE;
+
+    uint hash  = HashStringNoCase(name);
+    int slot   = 0;
+    int symbol = LookupSymbol(name, hash, &slot);
+    if (symbol != SYMBOL_NONE)
+        return symbol;
+
+    int len = StrLength(name) + 1;
+    if (symbolCount >= SYMBOL_COUNT || symbolPoolPos + len > SYMBOL_POOL_SIZE) {
+        PrintLog("Symbol table full, couldn't intern: %s", name);
+        return SYMBOL_NONE;
+    }
+
+    symbol                    = symbolCount++;
+    symbolHashes[symbol]      = hash;
+    symbolNameOffsets[symbol] = symbolPoolPos;
+    StrCopy(&symbolPool[symbolPoolPos], name);
+    symbolPoolPos += len;
+    symbolHashTable[slot] = symbol;
+    return symbol;
+}
+
+int FindSymbol(const char *name)
+{
+    if (!name || !name[0])
+        return SYMBOL_NONE;
+    return LookupSymbol(name, HashStringNoCase(name), NULL);
+}
+
+const char *GetSymbolName(int symbol)
+{
+    if (symbol <= SYMBOL_NONE || symbol >= symbolCount)
+        return "";
+    return &symbolPool[symbolNameOffsets[symbol]];
+}
+
+void UpdateSymbolStats()
+{
+    static int frames = 0;
+    static int total  = 0;
+
+    symbolComparesLastFrame = symbolCompareCount;
+    symbolCompareCount      = 0;
+    if (Engine.showSymbolStats) {
+        total += symbolComparesLastFrame;
+        if (++frames >= Engine.refreshRate) {
+            PrintLog("Symbols: %d interned, %d string compares/frame replaced (avg over %d frames)", symbolCount - 1, total / frames, frames);
+            frames = 0;
+            total  = 0;
+        }
+    }
+}
+#endif
@@ -55,4 +55,52 @@ inline int StrLength(const char *string)
 }
 int FindStringToken(const char *string, const char *token, sbyte stopID);
 
+#if !RETRO_USE_ORIGINAL_CODE
+// case is folded so strings that StrComp treats as equal hash the same
+inline uint HashStringNoCase(const char *string)
+{
+    uint hash = 0x811C9DC5;
+    for (; *string; ++string) {
+        char c = *string;
+        if (c >= 'a' && c <= 'z')
+            c -= 'a' - 'A';
+        hash = (hash ^ (byte)c) * 0x01000193;
+    }
+    return hash;
+}
+
+#define SYMBOL_COUNT     (0x800)
+#define SYMBOL_POOL_SIZE (0x10000)
+#define SYMBOL_NONE      (0)
+
+// names the engine looks up every frame, interned first so their IDs are fixed
+enum EngineSymbols {
+    SYMBOL_MINI_PLAYERFLAG = 1,
+    SYMBOL_PLAYER_AMY,
+    SYMBOL_ANI_HAMMER_JUMP,
+    SYMBOL_ANI_HAMMER_DASH,
+    SYMBOL_TOUCHCONTROLS,
+    SYMBOL_DPAD_SHEET,
+    SYMBOL_ENGINE_COUNT,
+};
+
+extern int symbolCount;
+extern int symbolCompareCount;
+extern int symbolComparesLastFrame;
+
+void InitSymbolTable();
+// Names match the same way StrComp does. Returns SYMBOL_NONE if the table is full
+int InternSymbol(const char *name);
+int FindSymbol(const char *name);
+const char *GetSymbolName(int symbol);
+void UpdateSymbolStats();
+
+// stands in for a StrComp on a hot path, counted so the savings can be shown
+inline bool SymbolMatch(int symbolA, int symbolB)
+{
+    ++symbolCompareCount;
+    return symbolA == symbolB;
+}
+#endif
+
 #endif // !STRING_H
@@ -1,5 +1,16 @@
 #include "RetroEngine.hpp"
 
+#if !RETRO_USE_ORIGINAL_CODE
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#if defined(_WIN32) && RETRO_PLATFORM != RETRO_UWP
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+#endif
+
 #if RETRO_PLATFORM == RETRO_WIN && _MSC_VER
 #include <Windows.h>
 #include <codecvt>
@@ -54,6 +65,9 @@ inline bool dirExists(const std::wstring &dirName_in)
 int globalVariablesCount;
 int globalVariables[GLOBALVAR_COUNT];
 char globalVariableNames[GLOBALVAR_COUNT][0x20];
+#if !RETRO_USE_ORIGINAL_CODE
+int globalVariableSymbols[GLOBALVAR_COUNT];
+#endif
 
 char gamePath[0x100];
 int saveRAM[SAVEDATA_SIZE];
@@ -73,6 +87,23 @@ extern "C" {
 #include <windows.h>
 #endif
 
+#if RETRO_PLATFORM == RETRO_3DS
+#define DEFAULT_SAVESTATE_KEY (KEY_L)
+#define DEFAULT_LOADSTATE_KEY (KEY_R)
+#elif RETRO_PLATFORM == RETRO_3DSSIM
+#define DEFAULT_SAVESTATE_KEY (VK_F6)
+#define DEFAULT_LOADSTATE_KEY (VK_F7)
+#elif RETRO_PLATFORM == RETRO_OSX
+#define DEFAULT_SAVESTATE_KEY (SDLK_F13) // F6/F7 are frame step and pause here
+#define DEFAULT_LOADSTATE_KEY (SDLK_F14)
+#elif RETRO_USING_SDL1 || RETRO_USING_SDL2
+#define DEFAULT_SAVESTATE_KEY (SDLK_F6)
+#define DEFAULT_LOADSTATE_KEY (SDLK_F7)
+#else
+#define DEFAULT_SAVESTATE_KEY (0)
+#define DEFAULT_LOADSTATE_KEY (0)
+#endif
+
 int controlMode              = -1;
 bool disableTouchControls    = false;
 int disableFocusPause        = 0;
@@ -85,6 +116,232 @@ bool forceUseScripts_Config = false;
 
 bool useSGame = false;
 
+#if !RETRO_USE_ORIGINAL_CODE
+struct SaveWrite {
+    char path[0x200];
+    byte *data;
+    int size;
+    int capacity;
+    std::chrono::steady_clock::time_point due;
+    bool pending;
+    bool failed; // the last write of this file didn't make it to disk
+};
+
+SaveWrite saveWrites[SAVEWRITE_SLOT_COUNT];
+int saveWritesBusy = 0;
+bool saveWriterQuit = false;
+bool saveWriteFlush = false;
+bool saveWriterExitAdded = false;
+std::mutex saveWriteMutex;
+std::condition_variable saveWriteCond;
+std::thread saveWriteThread;
+
+bool RecoverSaveWrite(const char *path, int size)
+{
+    char tempPath[0x210];
+    sprintf(tempPath, "%s.tmp", path);
+
+    FileIO *file = fOpen(path, "rb");
+    if (file) {
+        fClose(file);
+        return false;
+    }
+
+    file = fOpen(tempPath, "rb");
+    if (!file)
+        return false;
+    fSeek(file, 0, SEEK_END);
+    int tempSize = (int)fTell(file);
+    fClose(file);
+
+    // a crash while the first ever copy was being written leaves a short file, which is no better than none
+    if (size >= 0 && tempSize != size) {
+        PrintLog("WARNING: Ignoring incomplete save '%s'", tempPath);
+        return false;
+    }
+    if (rename(tempPath, path) != 0) {
+        PrintLog("ERROR: Couldn't restore '%s' from '%s'", path, tempPath);
+        return false;
+    }
+    PrintLog("Restored '%s' from an interrupted save", path);
+    return true;
+}
+
+// Writes next to the target then renames over it, so a crash mid-write leaves the old file intact
+static bool WriteFileAtomic(const char *path, const byte *data, int size)
+{
+    char tempPath[0x210];
+    sprintf(tempPath, "%s.tmp", path);
+
+    // don't truncate the only complete copy if the last write was interrupted after removing the target
+    RecoverSaveWrite(path, -1);
+
+    FileIO *file = fOpen(tempPath, "wb");
+    if (!file) {
+        PrintLog("ERROR: Couldn't open file '%s' for writing!", tempPath);
+        return false;
+    }
+    bool written = (int)fWrite(data, 1, size, file) == size;
+    fClose(file);
+    if (!written) {
+        remove(tempPath);
+        return false;
+    }
+
+#if defined(_WIN32) && RETRO_PLATFORM != RETRO_UWP
+    if (!MoveFileExA(tempPath, path, MOVEFILE_REPLACE_EXISTING))
+        return false;
+#else
+    if (rename(tempPath, path) != 0) {
+        // some filesystems (the 3DS SD card among them) won't rename over an existing file,
+        // if this is interrupted before the rename RecoverSaveWrite picks up the complete .tmp on the next read
+        remove(path);
+        if (rename(tempPath, path) != 0)
+            return false;
+    }
+#endif
+    return true;
+}
+
+static void ProcessSaveWrites()
+{
+    std::vector<byte> data;
+    char path[0x200];
+
+    std::unique_lock<std::mutex> lock(saveWriteMutex);
+    while (true) {
+        SaveWrite *next = NULL;
+        for (int i = 0; i < SAVEWRITE_SLOT_COUNT; ++i) {
+            if (saveWrites[i].pending && (!next || saveWrites[i].due < next->due))
+                next = &saveWrites[i];
+        }
+
+        if (!next) {
+            if (saveWriterQuit)
+                break;
+            saveWriteCond.wait(lock);
+            continue;
+        }
+        if (!saveWriteFlush && !saveWriterQuit && std::chrono::steady_clock::now() < next->due) {
+            saveWriteCond.wait_until(lock, next->due);
+            continue;
+        }
+
+        // take a copy so the game can queue the next version of this file while this one is written
+        data.assign(next->data, next->data + next->size);
+        StrCopy(path, next->path);
+        next->pending = false;
+        ++saveWritesBusy;
+
+        lock.unlock();
+        bool written = WriteFileAtomic(path, data.data(), (int)data.size());
+        if (!written)
+            PrintLog("ERROR: Failed to write '%s'", path);
+        lock.lock();
+
+        // the slot may have been handed to another file while this one was written
+        if (StrComp(next->path, path))
+            next->failed = !written;
+
+        --saveWritesBusy;
+        saveWriteCond.notify_all();
+    }
+}
+
+bool QueueSaveWrite(const char *path, const void *data, int size)
+{
+    std::unique_lock<std::mutex> lock(saveWriteMutex);
+
+    SaveWrite *slot = NULL;
+    for (int i = 0; i < SAVEWRITE_SLOT_COUNT && !slot; ++i) {
+        if (saveWrites[i].size && StrComp(saveWrites[i].path, path))
+            slot = &saveWrites[i];
+    }
+    for (int i = 0; i < SAVEWRITE_SLOT_COUNT && !slot; ++i) {
+        if (!saveWrites[i].pending)
+            slot = &saveWrites[i];
+    }
+
+    if (slot && slot->capacity < size) {
+        byte *buffer = (byte *)realloc(slot->data, size);
+        if (buffer) {
+            slot->data     = buffer;
+            slot->capacity = size;
+        }
+    }
+
+    if (!slot || slot->capacity < size) {
+        lock.unlock();
+        bool written = WriteFileAtomic(path, (const byte *)data, size);
+        if (!written)
+            PrintLog("ERROR: Failed to write '%s'", path);
+        return written;
+    }
+
+    if (!StrComp(slot->path, path))
+        slot->failed = false;
+    bool failed = slot->failed;
+    StrCopy(slot->path, path);
+    memcpy(slot->data, data, size);
+    slot->size = size;
+    // the window starts at the first write, so a stream of saves can't hold the file back forever
+    if (!slot->pending) {
+        slot->pending = true;
+        slot->due     = std::chrono::steady_clock::now() + std::chrono::milliseconds(SAVEWRITE_DELAY_MS);
+    }
+
+    if (!saveWriteThread.joinable()) {
+        if (!saveWriterExitAdded) {
+            // the tool modes return from main without going through Engine.Run, this still writes what's queued and joins the
+            // thread before the static thread object is destroyed
+            atexit(ReleaseSaveWriter);
+            saveWriterExitAdded = true;
+        }
+        saveWriterQuit  = false;
+        saveWriteThread = std::thread(ProcessSaveWrites);
+    }
+    saveWriteCond.notify_all();
+    return !failed;
+}
+
+void FlushSaveWrites()
+{
+    std::unique_lock<std::mutex> lock(saveWriteMutex);
+    if (!saveWriteThread.joinable())
+        return;
+
+    saveWriteFlush = true;
+    saveWriteCond.notify_all();
+    while (true) {
+        bool pending = saveWritesBusy > 0;
+        for (int i = 0; i < SAVEWRITE_SLOT_COUNT; ++i) pending |= saveWrites[i].pending;
+        if (!pending)
+            break;
+        saveWriteCond.wait(lock);
+    }
+    saveWriteFlush = false;
+}
+
+void ReleaseSaveWriter()
+{
+    {
+        std::unique_lock<std::mutex> lock(saveWriteMutex);
+        saveWriterQuit = true;
+        saveWriteCond.notify_all();
+    }
+    if (saveWriteThread.joinable())
+        saveWriteThread.join();
+
+    for (int i = 0; i < SAVEWRITE_SLOT_COUNT; ++i) {
+        if (saveWrites[i].data)
+            free(saveWrites[i].data);
+        saveWrites[i].data     = NULL;
+        saveWrites[i].size     = 0;
+        saveWrites[i].capacity = 0;
+    }
+}
+#endif
+
 //#if RETRO_PLATFORM == RETRO_LINUX
 //std::string getXDGDataPath() 
 //{
@@ -105,6 +362,9 @@ bool useSGame = false;
 
 bool ReadSaveRAMData()
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    FlushSaveWrites();
+#endif
     useSGame = false;
     char buffer[0x180];
 
@@ -149,6 +409,7 @@ bool ReadSaveRAMData()
 #if RETRO_USE_MOD_LOADER
     }
 #endif
+    RecoverSaveWrite(buffer, sizeof(int) * SAVEDATA_SIZE);
 #endif
 
     FileIO *saveFile = fOpen(buffer, "rb");
@@ -185,6 +446,9 @@ bool ReadSaveRAMData()
 #endif
 #endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+        RecoverSaveWrite(buffer, sizeof(int) * SAVEDATA_SIZE);
+#endif
         saveFile = fOpen(buffer, "rb");
         if (!saveFile)
             return false;
@@ -266,10 +530,6 @@ bool WriteSaveRAMData()
 #endif
     }
 
-    FileIO *saveFile = fOpen(buffer, "wb");
-    if (!saveFile)
-        return false;
-
 #if !RETRO_USE_ORIGINAL_CODE
 #if RETRO_USE_MOD_LOADER
     if (!disableSaveIniOverride) {
@@ -278,12 +538,20 @@ bool WriteSaveRAMData()
         saveRAM[34] = sfxVolume;
 #if RETRO_USE_MOD_LOADER
     }
-#endif
 #endif
 
+    // handed off to the save writer thread rather than blocking the game, so a failed write
+    // is reported by the next save of the same file (and logged by the writer when it happens)
+    return QueueSaveWrite(buffer, saveRAM, sizeof(int) * SAVEDATA_SIZE);
+#else
+    FileIO *saveFile = fOpen(buffer, "wb");
+    if (!saveFile)
+        return false;
+
     fWrite(saveRAM, 4, SAVEDATA_SIZE, saveFile);
     fClose(saveFile);
     return true;
+#endif
 }
 
 void InitUserdata()
@@ -357,6 +625,20 @@ void InitUserdata()
         ini.SetBool("Dev", "UseSteamDir", Engine.useSteamDir = false);
 #endif
         ini.SetBool("Dev", "UseHQModes", Engine.useHQModes = true);
+        ini.SetBool("Dev", "ShowInputLatency", Engine.showInputLatency = false);
+        ini.SetBool("Dev", "ShowSymbolStats", Engine.showSymbolStats = false);
+        ini.SetBool("Dev", "ShowSortStats", Engine.showSortStats = false);
+        ini.SetBool("Dev", "ShowObjectStats", Engine.showObjectStats = false);
+        ini.SetBool("Dev", "ScriptCache", Engine.useScriptCache = true);
+        ini.SetBool("Dev", "VerifyScriptCache", Engine.verifyScriptCache = false);
+        ini.SetBool("Dev", "VerifyEntityHotList", Engine.verifyEntityHotList = false);
+        ini.SetBool("Dev", "NativeScripts", Engine.useNativeScripts = true);
+        ini.SetBool("Dev", "VerifyNativeScripts", Engine.verifyNativeScripts = false);
+        ini.SetInteger("Dev", "ObjectWorkers", Engine.objectWorkers = -1);
+        ini.SetBool("Dev", "VerifyObjectWorkers", Engine.verifyObjectWorkers = false);
+        ini.SetInteger("Dev", "LogLevel", Engine.logLevel = LOGLEVEL_DEBUG);
+        ini.SetInteger("Dev", "SaveStateKey", Engine.saveStateKey = DEFAULT_SAVESTATE_KEY);
+        ini.SetInteger("Dev", "LoadStateKey", Engine.loadStateKey = DEFAULT_LOADSTATE_KEY);
         sprintf(Engine.dataFile, "%s", "Data.rsdk");
         ini.SetString("Dev", "DataFile", Engine.dataFile);
 
@@ -380,6 +662,7 @@ void InitUserdata()
         ini.SetInteger("Window", "RefreshRate", Engine.refreshRate = 60);
         ini.SetInteger("Window", "DimLimit", Engine.dimLimit = 300);
         Engine.dimLimit *= Engine.refreshRate;
+        ini.SetInteger("Window", "LateLatch", Engine.lateLatchMS = 0);
         renderType = RENDER_HW;
         ini.SetBool("Window", "HardwareRenderer", true);
 
@@ -492,6 +775,34 @@ void InitUserdata()
 #endif
         if (!ini.GetBool("Dev", "UseHQModes", &Engine.useHQModes))
             Engine.useHQModes = true;
+        if (!ini.GetBool("Dev", "ShowInputLatency", &Engine.showInputLatency))
+            Engine.showInputLatency = false;
+        if (!ini.GetBool("Dev", "ShowSymbolStats", &Engine.showSymbolStats))
+            Engine.showSymbolStats = false;
+        if (!ini.GetBool("Dev", "ShowSortStats", &Engine.showSortStats))
+            Engine.showSortStats = false;
+        if (!ini.GetBool("Dev", "ShowObjectStats", &Engine.showObjectStats))
+            Engine.showObjectStats = false;
+        if (!ini.GetBool("Dev", "ScriptCache", &Engine.useScriptCache))
+            Engine.useScriptCache = true;
+        if (!ini.GetBool("Dev", "VerifyScriptCache", &Engine.verifyScriptCache))
+            Engine.verifyScriptCache = false;
+        if (!ini.GetBool("Dev", "VerifyEntityHotList", &Engine.verifyEntityHotList))
+            Engine.verifyEntityHotList = false;
+        if (!ini.GetBool("Dev", "NativeScripts", &Engine.useNativeScripts))
+            Engine.useNativeScripts = true;
+        if (!ini.GetBool("Dev", "VerifyNativeScripts", &Engine.verifyNativeScripts))
+            Engine.verifyNativeScripts = false;
+        if (!ini.GetInteger("Dev", "ObjectWorkers", &Engine.objectWorkers))
+            Engine.objectWorkers = -1;
+        if (!ini.GetBool("Dev", "VerifyObjectWorkers", &Engine.verifyObjectWorkers))
+            Engine.verifyObjectWorkers = false;
+        if (!ini.GetInteger("Dev", "LogLevel", &Engine.logLevel))
+            Engine.logLevel = LOGLEVEL_DEBUG;
+        if (!ini.GetInteger("Dev", "SaveStateKey", &Engine.saveStateKey))
+            Engine.saveStateKey = DEFAULT_SAVESTATE_KEY;
+        if (!ini.GetInteger("Dev", "LoadStateKey", &Engine.loadStateKey))
+            Engine.loadStateKey = DEFAULT_LOADSTATE_KEY;
 
         Engine.startList_Game  = Engine.startList;
         Engine.startStage_Game = Engine.startStage;
@@ -541,6 +852,8 @@ void InitUserdata()
             Engine.dimLimit = 300; // 5 mins
         if (Engine.dimLimit >= 0)
             Engine.dimLimit *= Engine.refreshRate;
+        if (!ini.GetInteger("Window", "LateLatch", &Engine.lateLatchMS))
+            Engine.lateLatchMS = 0;
         bool hwRender = true;
         ini.GetBool("Window", "HardwareRenderer", &hwRender);
         if (hwRender)
@@ -840,6 +1153,33 @@ void WriteSettings()
         "Dev", "UseHQComment",
         "Determines if applicable rendering modes (such as 3D floor from special stages) will render in \"High Quality\" mode or standard mode");
     ini.SetBool("Dev", "UseHQModes", Engine.useHQModes);
+    ini.SetComment("Dev", "ILComment", "Shows a graph of the time from reading a button press to presenting the frame that used it");
+    ini.SetBool("Dev", "ShowInputLatency", Engine.showInputLatency);
+    ini.SetComment("Dev", "SymbolStatsComment", "Logs how many string compares per frame were replaced by interned symbol lookups");
+    ini.SetBool("Dev", "ShowSymbolStats", Engine.showSymbolStats);
+    ini.SetComment("Dev", "SortStatsComment", "Logs how many 3D faces are depth sorted per frame, averaged and peak over each second");
+    ini.SetBool("Dev", "ShowSortStats", Engine.showSortStats);
+    ini.SetComment("Dev", "ObjectStatsComment", "Logs how long ProcessObjects takes per frame, averaged and slowest over each second");
+    ini.SetBool("Dev", "ShowObjectStats", Engine.showObjectStats);
+    ini.SetComment("Dev", "ScriptCacheComment", "Caches scripts compiled from text in ScriptCache/ so unchanged scripts skip compiling on the next load");
+    ini.SetBool("Dev", "ScriptCache", Engine.useScriptCache);
+    ini.SetComment("Dev", "VerifyScriptCacheComment", "Compiles cached scripts anyway and checks the cache entry matches the fresh result byte for byte");
+    ini.SetBool("Dev", "VerifyScriptCache", Engine.verifyScriptCache);
+    ini.SetComment("Dev", "VerifyEntityHotListComment", "Checks every frame that the compact entity fields used by the object passes are in sync");
+    ini.SetBool("Dev", "VerifyEntityHotList", Engine.verifyEntityHotList);
+    ini.SetComment("Dev", "NativeScriptsComment", "Runs object scripts that were translated to C++ by the scriptaot tool instead of interpreting them");
+    ini.SetBool("Dev", "NativeScripts", Engine.useNativeScripts);
+    ini.SetComment("Dev", "VerifyNativeScriptsComment", "Runs each frame's objects through both the interpreter and the native scripts and logs where they differ");
+    ini.SetBool("Dev", "VerifyNativeScripts", Engine.verifyNativeScripts);
+    ini.SetComment("Dev", "ObjectWorkersComment", "Threads that update self-contained objects alongside the main thread, -1 for one per spare core, 0 to update everything serially");
+    ini.SetInteger("Dev", "ObjectWorkers", Engine.objectWorkers);
+    ini.SetComment("Dev", "VerifyObjectWorkersComment", "Runs each frame's objects serially and then with the object workers and logs where they differ");
+    ini.SetBool("Dev", "VerifyObjectWorkers", Engine.verifyObjectWorkers);
+    ini.SetComment("Dev", "LogLevelComment", "Lowest level of message written to the log (0 = debug, 1 = info, 2 = warnings, 3 = errors)");
+    ini.SetInteger("Dev", "LogLevel", Engine.logLevel);
+    ini.SetComment("Dev", "StateKeyComment", "Keys that save and restore a snapshot of the running stage while the dev menu is enabled");
+    ini.SetInteger("Dev", "SaveStateKey", Engine.saveStateKey);
+    ini.SetInteger("Dev", "LoadStateKey", Engine.loadStateKey);
 
     ini.SetComment("Dev", "DataFileComment", "Determines what RSDK file will be loaded");
     ini.SetString("Dev", "DataFile", Engine.dataFile);
@@ -875,6 +1215,9 @@ void WriteSettings()
     ini.SetInteger("Window", "RefreshRate", Engine.refreshRate);
     ini.SetComment("Window", "DLComment", "Determines the dim timer in seconds, set to -1 to disable dimming");
     ini.SetInteger("Window", "DimLimit", Engine.dimLimit >= 0 ? Engine.dimLimit / Engine.refreshRate : -1);
+    ini.SetComment("Window", "LLComment",
+                   "Milliseconds before the next vsync to start the game update, so input is read as late as possible. 0 disables it, needs VSync");
+    ini.SetInteger("Window", "LateLatch", Engine.lateLatchMS);
     ini.SetComment("Window", "HWComment", "Determines the game uses hardware rendering (like mobile) or software rendering (like PC)");
     ini.SetBool("Window", "HardwareRenderer", renderType == RENDER_HW);
 
@@ -948,6 +1291,9 @@ void WriteSettings()
 
 void ReadUserdata()
 {
+#if !RETRO_USE_ORIGINAL_CODE
+    FlushSaveWrites();
+#endif
     char buffer[0x200];
 #if RETRO_USE_MOD_LOADER
 #if RETRO_PLATFORM == RETRO_UWP
@@ -981,6 +1327,9 @@ void ReadUserdata()
 #endif
 #endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+    RecoverSaveWrite(buffer, sizeof(int) * (ACHIEVEMENT_COUNT + LEADERBOARD_COUNT));
+#endif
     FileIO *userFile = fOpen(buffer, "rb");
     if (!userFile)
         return;
@@ -1039,6 +1388,12 @@ void WriteUserdata()
 #endif
 #endif
 
+#if !RETRO_USE_ORIGINAL_CODE
+    int userData[ACHIEVEMENT_COUNT + LEADERBOARD_COUNT];
+    for (int a = 0; a < ACHIEVEMENT_COUNT; ++a) userData[a] = achievements[a].status;
+    for (int l = 0; l < LEADERBOARD_COUNT; ++l) userData[ACHIEVEMENT_COUNT + l] = leaderboards[l].score;
+    QueueSaveWrite(buffer, userData, sizeof(userData));
+#else
     FileIO *userFile = fOpen(buffer, "wb");
     if (!userFile)
         return;
@@ -1047,6 +1402,7 @@ void WriteUserdata()
     for (int l = 0; l < LEADERBOARD_COUNT; ++l) fWrite(&leaderboards[l].score, 4, 1, userFile);
 
     fClose(userFile);
+#endif
 
     if (Engine.onlineActive) {
         // Load from online
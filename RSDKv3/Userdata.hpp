@@ -27,6 +27,9 @@ struct LeaderboardEntry {
 extern int globalVariablesCount;
 extern int globalVariables[GLOBALVAR_COUNT];
 extern char globalVariableNames[GLOBALVAR_COUNT][0x20];
+#if !RETRO_USE_ORIGINAL_CODE
+extern int globalVariableSymbols[GLOBALVAR_COUNT];
+#endif
 
 extern char gamePath[0x100];
 extern int saveRAM[SAVEDATA_SIZE];
@@ -52,6 +55,17 @@ inline int GetGlobalVariableByName(const char *name)
     return 0;
 }
 
+#if !RETRO_USE_ORIGINAL_CODE
+inline int GetGlobalVariableBySymbol(int symbol)
+{
+    for (int v = 0; v < globalVariablesCount; ++v) {
+        if (SymbolMatch(symbol, globalVariableSymbols[v]))
+            return globalVariables[v];
+    }
+    return 0;
+}
+#endif
+
 inline void SetGlobalVariableByName(const char *name, int value)
 {
     for (int v = 0; v < globalVariablesCount; ++v) {
@@ -66,6 +80,18 @@ extern bool useSGame;
 bool ReadSaveRAMData();
 bool WriteSaveRAMData();
 
+#if !RETRO_USE_ORIGINAL_CODE
+#define SAVEWRITE_SLOT_COUNT (4)
+#define SAVEWRITE_DELAY_MS   (250) // writes to the same file within this window go out as one
+
+// Returns false if the write couldn't be queued and failed, or if the last queued write of this file failed
+bool QueueSaveWrite(const char *path, const void *data, int size);
+// Restores path from a complete <path>.tmp left by an interrupted write (size -1 accepts any size)
+bool RecoverSaveWrite(const char *path, int size);
+void FlushSaveWrites();
+void ReleaseSaveWriter();
+#endif
+
 void InitUserdata();
 void WriteSettings();
 void ReadUserdata();
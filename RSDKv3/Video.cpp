@@ -26,6 +26,11 @@ int vidBaseticks  = 0;
 bool videoSkipped = false;
 
 #if RETRO_PLATFORM != RETRO_3DS
+VideoStats videoStats;
+int videoDecodeAhead    = VIDEO_DECODE_AHEAD_DEFAULT;
+float videoDecodeAvgMS  = 0.0f;
+uint videoLastPlayMS    = 0;
+
 static long videoRead(THEORAPLAY_Io *io, void *buf, long buflen)
 {
     FileIO *file    = (FileIO *)io->userdata;
@@ -42,6 +47,90 @@ static void videoClose(THEORAPLAY_Io *io)
 }
 #endif
 
+#if RETRO_USING_OPENGL && RETRO_PLATFORM != RETRO_3DS
+// IYUV frame buffers are recycled instead of being malloc'd and freed for every decoded frame.
+// theoraplay frees queued frames with free() itself, so pooled buffers must stay plain malloc blocks
+#define VIDEOFRAME_POOL_SIZE (8)
+
+void *videoFramePool[VIDEOFRAME_POOL_SIZE];
+int videoFramePoolCount = 0;
+uint videoFramePoolSize = 0;
+
+static void *videoAllocate(const THEORAPLAY_Allocator *, unsigned int len)
+{
+    if (len == videoFramePoolSize && videoFramePoolCount > 0)
+        return videoFramePool[--videoFramePoolCount];
+    return malloc(len);
+}
+
+static void videoDeallocate(const THEORAPLAY_Allocator *, void *ptr) { free(ptr); }
+
+THEORAPLAY_Allocator videoAllocator = { videoAllocate, videoDeallocate, NULL };
+
+static void ClearVideoFramePool()
+{
+    while (videoFramePoolCount > 0) free(videoFramePool[--videoFramePoolCount]);
+    videoFramePoolSize = 0;
+}
+
+static void ReleaseVideoFrame(const THEORAPLAY_VideoFrame *frame)
+{
+    THEORAPLAY_VideoFrame *item = (THEORAPLAY_VideoFrame *)frame;
+    uint size                   = item->width * item->height * 2;
+    if (size != videoFramePoolSize) {
+        ClearVideoFramePool();
+        videoFramePoolSize = size;
+    }
+
+    if (videoFramePoolCount < VIDEOFRAME_POOL_SIZE)
+        videoFramePool[videoFramePoolCount++] = item->pixels;
+    else
+        free(item->pixels);
+    free(item);
+}
+#else
+#define ReleaseVideoFrame(frame) THEORAPLAY_freeVideo(frame)
+#endif
+
+#if RETRO_PLATFORM != RETRO_3DS
+// Decodes ahead as far as fits in half an engine frame, based on how long recent frames took to decode
+static void PumpVideoDecoder()
+{
+    int queued                 = THEORAPLAY_availableVideo(videoDecoder);
+    unsigned long long start   = Time_GetPerformanceCounter();
+    THEORAPLAY_pumpDecode(videoDecoder, videoDecodeAhead);
+    unsigned long long elapsed = Time_GetPerformanceCounter() - start;
+
+    int decoded = (int)THEORAPLAY_availableVideo(videoDecoder) - queued;
+    if (decoded <= 0)
+        return;
+
+    float totalMS = (float)(elapsed * 1000.0 / Time_GetPerformanceFrequency());
+    float frameMS = totalMS / decoded;
+    videoStats.decodedFrames += decoded;
+    videoStats.decodeMS += totalMS;
+    if (frameMS > videoStats.decodeMaxMS)
+        videoStats.decodeMaxMS = frameMS;
+
+    if (videoDecodeAvgMS > 0.0f)
+        videoDecodeAvgMS += (frameMS - videoDecodeAvgMS) * 0.125f;
+    else
+        videoDecodeAvgMS = frameMS;
+
+    // never fall below the number of video frames due per engine frame, or playback can't keep up at all
+    float tickMS = 1000.0f / Engine.refreshRate;
+    int minDepth = vidFrameMS ? (int)ceilf(tickMS / vidFrameMS) : VIDEO_DECODE_AHEAD_MIN;
+    int depth    = videoDecodeAvgMS > 0.0f ? (int)(tickMS * 0.5f / videoDecodeAvgMS) : VIDEO_DECODE_AHEAD_MAX;
+    if (depth < minDepth)
+        depth = minDepth;
+    if (depth < VIDEO_DECODE_AHEAD_MIN)
+        depth = VIDEO_DECODE_AHEAD_MIN;
+    if (depth > VIDEO_DECODE_AHEAD_MAX)
+        depth = VIDEO_DECODE_AHEAD_MAX;
+    videoDecodeAhead = depth;
+}
+#endif
+
 void PlayVideoFile(char *filePath)
 {
     char pathBuffer[0x100];
@@ -64,17 +153,13 @@ void PlayVideoFile(char *filePath)
     }
 
 #if RETRO_USE_MOD_LOADER
-    for (int m = 0; m < modList.size(); ++m) {
-        if (modList[m].active) {
-            std::map<std::string, std::string>::const_iterator iter = modList[m].fileMap.find(pathLower);
-            if (iter != modList[m].fileMap.cend()) {
-                StrCopy(pathBuffer, iter->second.c_str());
-                Engine.forceFolder   = true;
-                Engine.usingDataFile = false;
-                addPath              = false;
-                break;
-            }
-        }
+    // videos are streamed by path, so only loose files can be used
+    std::unordered_map<std::string, ModFile>::const_iterator iter = modFileMap.find(pathLower);
+    if (iter != modFileMap.cend() && iter->second.offset < 0) {
+        StrCopy(pathBuffer, iter->second.path.c_str());
+        Engine.forceFolder   = true;
+        Engine.usingDataFile = false;
+        addPath              = false;
     }
 #endif
 
@@ -121,20 +206,26 @@ void PlayVideoFile(char *filePath)
     if (file) {
         PrintLog("Loaded File '%s'!", filepath);
 
+        MEM_ZERO(videoStats);
+        videoDecodeAhead = VIDEO_DECODE_AHEAD_DEFAULT;
+        videoDecodeAvgMS = 0.0f;
+        videoLastPlayMS  = 0;
+
         callbacks.read     = videoRead;
         callbacks.close    = videoClose;
         callbacks.userdata = (void *)file;
 #if RETRO_USING_SDL2 && !RETRO_USING_OPENGL
-        videoDecoder = THEORAPLAY_startDecode(&callbacks, /*FPS*/ 30, THEORAPLAY_VIDFMT_IYUV, GetGlobalVariableByName("Options.Soundtrack") ? 1 : 0);
+        videoDecoder = THEORAPLAY_startDecode(&callbacks, VIDEO_DECODE_BUFFER, THEORAPLAY_VIDFMT_IYUV, GetGlobalVariableByName("Options.Soundtrack") ? 1 : 0);
 #endif
 
         // TODO: does SDL1.2 support YUV?
 #if RETRO_USING_SDL1 && !RETRO_USING_OPENGL
-        videoDecoder = THEORAPLAY_startDecode(&callbacks, /*FPS*/ 30, THEORAPLAY_VIDFMT_RGBA, GetGlobalVariableByName("Options.Soundtrack") ? 1 : 0);
+        videoDecoder = THEORAPLAY_startDecode(&callbacks, VIDEO_DECODE_BUFFER, THEORAPLAY_VIDFMT_RGBA, GetGlobalVariableByName("Options.Soundtrack") ? 1 : 0);
 #endif
 
 #if RETRO_USING_OPENGL
-        videoDecoder = THEORAPLAY_startDecode(&callbacks, /*FPS*/ 30, THEORAPLAY_VIDFMT_RGBA, NULL, 0);
+        // decoded straight to planar YUV, the conversion to RGB happens in the texture's shader
+        videoDecoder = THEORAPLAY_startDecode(&callbacks, VIDEO_DECODE_BUFFER, THEORAPLAY_VIDFMT_IYUV, &videoAllocator, 0);
 #endif
 
         if (!videoDecoder) {
@@ -142,7 +233,7 @@ void PlayVideoFile(char *filePath)
             return;
         }
         while (!videoVidData) {
-            THEORAPLAY_pumpDecode(videoDecoder, 5);
+            PumpVideoDecoder();
 
             if (!videoVidData)
                 videoVidData = THEORAPLAY_getVideo(videoDecoder);
@@ -268,13 +359,17 @@ int ProcessVideo()
 #if RETRO_PLATFORM == RETRO_3DS
             ProcessVideo3DS();
 #else
-            THEORAPLAY_pumpDecode(videoDecoder, 5);
+            PumpVideoDecoder();
 
             const unsigned int now = (Time_GetTicks() - vidBaseticks);
 
             if (!videoVidData)
                 videoVidData = THEORAPLAY_getVideo(videoDecoder);
 
+            // the next frame is already due but hasn't been decoded yet, so the last one stays on screen again
+            if (!videoVidData && videoStats.presentedFrames && vidFrameMS && now >= videoLastPlayMS + 2 * vidFrameMS)
+                videoStats.duplicatedFrames++;
+
             // Play video frames when it's time.
             if (videoVidData && (videoVidData->playms <= now)) {
                 if (vidFrameMS && ((now - videoVidData->playms) >= vidFrameMS)) {
@@ -286,8 +381,9 @@ int ProcessVideo()
 
                     const THEORAPLAY_VideoFrame *last = videoVidData;
                     while ((videoVidData = THEORAPLAY_getVideo(videoDecoder)) != NULL) {
-                        THEORAPLAY_freeVideo(last);
-                        THEORAPLAY_pumpDecode(videoDecoder, 5);
+                        ReleaseVideoFrame(last);
+                        videoStats.droppedFrames++;
+                        PumpVideoDecoder();
                         last = videoVidData;
                         if ((now - videoVidData->playms) < vidFrameMS)
                             break;
@@ -297,13 +393,13 @@ int ProcessVideo()
                         videoVidData = last;
                 }
 
-                // do nothing; we're far behind and out of options.
-                if (!videoVidData) {
-                    // video lagging uh oh
-                }
+                // shown at least an engine frame after it was due
+                if ((now - videoVidData->playms) * Engine.refreshRate >= 1000)
+                    videoStats.lateFrames++;
+                videoStats.presentedFrames++;
+                videoLastPlayMS = videoVidData->playms;
 
 #if RETRO_USING_OPENGL
-                Gfx_TextureBind(videoBuffer);
                 Gfx_TextureUpload(videoBuffer, videoVidData->pixels);
 #elif RETRO_USING_SDL2
                 int half_w     = videoVidData->width / 2;
@@ -316,7 +412,7 @@ int ProcessVideo()
                 memcpy(Engine.videoBuffer->pixels, videoVidData->pixels, videoVidData->width * videoVidData->height * sizeof(uint));
 #endif
 
-                THEORAPLAY_freeVideo(videoVidData);
+                ReleaseVideoFrame(videoVidData);
                 videoVidData = NULL;
             }
 #endif
@@ -349,13 +445,21 @@ void StopVideoPlayback()
             fadeMode = 0;
 
         if (videoVidData) {
-            THEORAPLAY_freeVideo(videoVidData);
+            ReleaseVideoFrame(videoVidData);
             videoVidData = NULL;
         }
         if (videoDecoder) {
+            PrintLog("Video stats: %d presented, %d dropped, %d late, %d duplicated", videoStats.presentedFrames, videoStats.droppedFrames,
+                     videoStats.lateFrames, videoStats.duplicatedFrames);
+            PrintLog("Video decode: %d frames, %.2fms avg, %.2fms max, decode-ahead %d", videoStats.decodedFrames,
+                     videoStats.decodedFrames ? videoStats.decodeMS / videoStats.decodedFrames : 0.0f, videoStats.decodeMaxMS, videoDecodeAhead);
+
             THEORAPLAY_stopDecode(videoDecoder);
             videoDecoder = NULL;
         }
+#if RETRO_USING_OPENGL
+        ClearVideoFramePool();
+#endif
 
         CloseVideoBuffer();
         videoPlaying = 0;
@@ -374,7 +478,7 @@ void SetupVideoBuffer(int width, int height)
         Gfx_TextureDestroy(videoBuffer);
         videoBuffer = 0;
     }
-    videoBuffer = Gfx_TextureCreate(width, height, false, false);
+    videoBuffer = Gfx_TextureCreateYUV(width, height);
     Gfx_TextureUpload(videoBuffer, videoVidData->pixels);
     Gfx_TextureSetFilter(videoBuffer, true);
 #elif RETRO_USING_SDL1
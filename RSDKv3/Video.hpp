@@ -3,6 +3,21 @@
 
 #if RETRO_PLATFORM != RETRO_3DS
 #include "theoraplay.h"
+
+#define VIDEO_DECODE_BUFFER        (30) // max frames theoraplay keeps queued
+#define VIDEO_DECODE_AHEAD_MIN     (1)
+#define VIDEO_DECODE_AHEAD_MAX     (8)
+#define VIDEO_DECODE_AHEAD_DEFAULT (5)
+
+struct VideoStats {
+    int presentedFrames;
+    int droppedFrames;    // skipped to catch up
+    int lateFrames;       // presented an engine frame or more after their time
+    int duplicatedFrames; // engine frames where the next frame was due but not decoded yet
+    int decodedFrames;
+    float decodeMS;
+    float decodeMaxMS;
+};
 #endif
 
 extern int currentVideoFrame;
@@ -16,6 +31,9 @@ extern THEORAPLAY_Decoder *videoDecoder;
 extern const THEORAPLAY_VideoFrame *videoVidData;
 extern const THEORAPLAY_AudioPacket *videoAudioData;
 extern THEORAPLAY_Io callbacks;
+
+extern VideoStats videoStats;
+extern int videoDecodeAhead;
 #endif
 
 extern byte videoSurface;
@@ -6,6 +6,12 @@
 #include "Windows.h"
 #endif
 
+char traceComparePaths[2][0x100];
+int iniBenchKeys = 0;
+char scriptAOTPath[0x100];
+char modPackFolder[0x100];
+int loaderBenchRuns = 0;
+
 void parseArguments(int argc, char *argv[])
 {
     for (int a = 0; a < argc; ++a) {
@@ -44,6 +50,87 @@ void parseArguments(int argc, char *argv[])
         if (find) {
             usingCWD = true;
         }
+
+        find = strstr(argv[a], "audiorender=");
+        if (find) {
+            int b = 0;
+            int c = 12;
+            while (find[c] && find[c] != ';' && b < (int)sizeof(offlineAudioPath) - 1) offlineAudioPath[b++] = find[c++];
+            offlineAudioPath[b] = 0;
+        }
+
+        find = strstr(argv[a], "record=");
+        if (find) {
+            int b = 0;
+            int c = 7;
+            while (find[c] && find[c] != ';' && b < (int)sizeof(replayPath) - 1) replayPath[b++] = find[c++];
+            replayPath[b] = 0;
+            replayMode    = REPLAY_RECORD;
+        }
+
+        find = strstr(argv[a], "replay=");
+        if (find) {
+            int b = 0;
+            int c = 7;
+            while (find[c] && find[c] != ';' && b < (int)sizeof(replayPath) - 1) replayPath[b++] = find[c++];
+            replayPath[b] = 0;
+            replayMode    = REPLAY_PLAY;
+        }
+
+        find = strstr(argv[a], "replayhash=");
+        if (find)
+            replayHashInterval = atoi(find + 11);
+
+        find = strstr(argv[a], "trace=");
+        if (find) {
+            int b = 0;
+            int c = 6;
+            while (find[c] && find[c] != ';' && b < (int)sizeof(stateTracePath) - 1) stateTracePath[b++] = find[c++];
+            stateTracePath[b] = 0;
+        }
+
+        find = strstr(argv[a], "tracefb=true");
+        if (find)
+            stateTraceFrameBuffer = true;
+
+        find = strstr(argv[a], "inibench=");
+        if (find)
+            iniBenchKeys = atoi(find + 9);
+
+        find = strstr(argv[a], "loaderbench=");
+        if (find)
+            loaderBenchRuns = atoi(find + 12);
+
+        find = strstr(argv[a], "scriptaot=");
+        if (find) {
+            int b = 0;
+            int c = 10;
+            while (find[c] && find[c] != ';' && b < (int)sizeof(scriptAOTPath) - 1) scriptAOTPath[b++] = find[c++];
+            scriptAOTPath[b] = 0;
+        }
+
+        find = strstr(argv[a], "modpack=");
+        if (find) {
+            int b = 0;
+            int c = 8;
+            while (find[c] && find[c] != ';' && b < (int)sizeof(modPackFolder) - 1) modPackFolder[b++] = find[c++];
+            modPackFolder[b] = 0;
+        }
+
+        // tracecompare=<a>,<b>
+        find = strstr(argv[a], "tracecompare=");
+        if (find) {
+            int b = 0;
+            int c = 13;
+            while (find[c] && find[c] != ',' && b < (int)sizeof(traceComparePaths[0]) - 1) traceComparePaths[0][b++] = find[c++];
+            traceComparePaths[0][b] = 0;
+
+            b = 0;
+            if (find[c] == ',')
+                ++c;
+            while (find[c] && find[c] != ';' && b < (int)sizeof(traceComparePaths[1]) - 1) traceComparePaths[1][b++] = find[c++];
+            traceComparePaths[1][b] = 0;
+        }
     }
 }
 #endif
@@ -60,9 +147,32 @@ int main(int argc, char *argv[])
 
 #if !RETRO_USE_ORIGINAL_CODE
     parseArguments(argc, argv);
+
+    // tool mode, no engine init
+    if (traceComparePaths[0][0] && traceComparePaths[1][0]) {
+        engineDebugMode = true;
+        return CompareStateTraces(traceComparePaths[0], traceComparePaths[1]);
+    }
+    if (iniBenchKeys > 0) {
+        engineDebugMode = true;
+        return BenchmarkIniParser(iniBenchKeys);
+    }
+    if (scriptAOTPath[0] || modPackFolder[0] || loaderBenchRuns > 0)
+        engineDebugMode = true;
 #endif
 
     Engine.Init();
+#if !RETRO_USE_ORIGINAL_CODE
+    // tool mode, needs the data file and game config from Init
+    if (scriptAOTPath[0])
+        return TranslateScriptBytecode(scriptAOTPath);
+    if (loaderBenchRuns > 0)
+        return BenchmarkLoaders(loaderBenchRuns);
+#if RETRO_USE_MOD_LOADER
+    if (modPackFolder[0])
+        return BuildModPack(modPackFolder);
+#endif
+#endif
     Engine.Run();
 
 #if !RETRO_USE_ORIGINAL_CODE
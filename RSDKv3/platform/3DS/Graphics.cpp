@@ -97,6 +97,11 @@ void Gfx_FrameBegin()
     C3D_FrameDrawOn(mainRT[STEREO_EYE_LEFT]);
 }
 
+void Gfx_PollEvents()
+{
+    // hid is scanned in ProcessInput, which already runs after the latch
+}
+
 void Gfx_FrameEnd(GfxContext* ctx)
 {
     C3D_FrameEnd(0);
@@ -30,10 +30,16 @@ unsigned int Time_GetTicks()
 
 unsigned long long Time_GetPerformanceFrequency()
 {
-    return osGetTimeRef().sysclock_hz;
+    return SYSCLOCK_ARM11;
 }
 
 unsigned long long Time_GetPerformanceCounter()
 {
-    return osGetTimeRef().value_tick;
+    // osGetTimeRef() only holds the tick of the last time sync, the system tick is the live counter
+    return svcGetSystemTick();
+}
+
+void Time_Sleep(unsigned int ms)
+{
+    svcSleepThread((s64)ms * 1000000);
 }
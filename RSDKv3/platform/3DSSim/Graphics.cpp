@@ -6,6 +6,8 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include "Debug.hpp" // For PrintLog()
+
 // Context functions
 
 typedef struct GfxContext {
@@ -14,6 +16,8 @@ typedef struct GfxContext {
 
 static GLuint mainRT[MAX_STEREO_EYES];
 static GLuint mainRTRightTex;
+static GLuint yuvProgram = 0;
+static bool yuvProgramFailed = false;
 
 GfxContext* Gfx_Initialize(const char* gameTitle)
 {
@@ -86,6 +90,11 @@ void Gfx_FrameBegin()
     glfwPollEvents();
 }
 
+void Gfx_PollEvents()
+{
+    glfwPollEvents();
+}
+
 void Gfx_FrameEnd(GfxContext* ctx)
 {
     glfwSwapBuffers(ctx->window);
@@ -95,6 +104,8 @@ void Gfx_Finalize(GfxContext* ctx)
 {
     glDeleteFramebuffers(1, &mainRT[STEREO_EYE_RIGHT]);
     glDeleteTextures(1, &mainRTRightTex);
+    if (yuvProgram)
+        glDeleteProgram(yuvProgram);
 
     glfwDestroyWindow(ctx->window);
     free(ctx);
@@ -148,14 +159,101 @@ typedef struct GfxTexture {
     int height;
     GLenum type;
     GLuint texID;
+    // YUV textures keep each IYUV plane in its own luminance texture (Y, U, V)
+    bool isYUV;
+    GLuint planeIDs[3];
 } GfxTexture;
 
+static const char *yuvVertexShader =
+    "#version 110\n"
+    "void main() {\n"
+    "    gl_Position    = ftransform();\n"
+    "    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+    "    gl_FrontColor  = gl_Color;\n"
+    "}\n";
+
+// Same BT.601 coefficients theoraplay uses for its RGBA conversion
+static const char *yuvFragmentShader =
+    "#version 110\n"
+    "uniform sampler2D texY;\n"
+    "uniform sampler2D texU;\n"
+    "uniform sampler2D texV;\n"
+    "void main() {\n"
+    "    float y  = (texture2D(texY, gl_TexCoord[0].st).r - 0.0625) * 1.1640625;\n"
+    "    float cb = texture2D(texU, gl_TexCoord[0].st).r - 0.5;\n"
+    "    float cr = texture2D(texV, gl_TexCoord[0].st).r - 0.5;\n"
+    "    vec3 rgb = vec3(y + 1.59375 * cr, y - 0.8125 * cr - 0.390625 * cb, y + 2.015625 * cb);\n"
+    "    gl_FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0) * gl_Color;\n"
+    "}\n";
+
+static GLuint CompileYUVShader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        char infoLog[0x400];
+        glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+        PrintLog("ERROR: Couldn't compile the YUV %s shader: %s", type == GL_VERTEX_SHADER ? "vertex" : "fragment", infoLog);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// If the program can't be built, YUV textures draw through the fixed pipeline (just the Y plane, in greyscale)
+static void InitYUVProgram()
+{
+    if (yuvProgram || yuvProgramFailed)
+        return;
+
+    GLuint vert = CompileYUVShader(GL_VERTEX_SHADER, yuvVertexShader);
+    GLuint frag = CompileYUVShader(GL_FRAGMENT_SHADER, yuvFragmentShader);
+    if (!vert || !frag) {
+        if (vert)
+            glDeleteShader(vert);
+        if (frag)
+            glDeleteShader(frag);
+        yuvProgramFailed = true;
+        return;
+    }
+
+    yuvProgram = glCreateProgram();
+    glAttachShader(yuvProgram, vert);
+    glAttachShader(yuvProgram, frag);
+    glLinkProgram(yuvProgram);
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(yuvProgram, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        char infoLog[0x400];
+        glGetProgramInfoLog(yuvProgram, sizeof(infoLog), NULL, infoLog);
+        PrintLog("ERROR: Couldn't link the YUV shader program: %s", infoLog);
+        glDeleteProgram(yuvProgram);
+        yuvProgram       = 0;
+        yuvProgramFailed = true;
+        return;
+    }
+
+    glUseProgram(yuvProgram);
+    glUniform1i(glGetUniformLocation(yuvProgram, "texY"), 0);
+    glUniform1i(glGetUniformLocation(yuvProgram, "texU"), 1);
+    glUniform1i(glGetUniformLocation(yuvProgram, "texV"), 2);
+    glUseProgram(0);
+}
+
 GfxTexture* Gfx_TextureCreate(int width, int height, bool isRGB5A1, bool isVRAM)
 {
     GfxTexture *ret = (GfxTexture*)malloc(sizeof(GfxTexture));
     ret->width = width;
     ret->height = height;
     ret->type = isRGB5A1 ? GL_UNSIGNED_SHORT_5_5_5_1 : GL_UNSIGNED_INT_8_8_8_8;
+    ret->isYUV = false;
 
     glGenTextures(1, &ret->texID);
     glBindTexture(GL_TEXTURE_2D, ret->texID);
@@ -176,13 +274,72 @@ GfxTexture* Gfx_TextureCreate(int width, int height, bool isRGB5A1, bool isVRAM)
     return ret;
 }
 
+GfxTexture* Gfx_TextureCreateYUV(int width, int height)
+{
+    InitYUVProgram();
+
+    GfxTexture *ret = (GfxTexture*)malloc(sizeof(GfxTexture));
+    ret->width = width;
+    ret->height = height;
+    ret->type = GL_UNSIGNED_BYTE;
+    ret->isYUV = true;
+
+    glGenTextures(3, ret->planeIDs);
+    ret->texID = ret->planeIDs[0];
+    for (int p = 0; p < 3; ++p) {
+        glBindTexture(GL_TEXTURE_2D, ret->planeIDs[p]);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            GL_LUMINANCE,
+            p ? width >> 1 : width,
+            p ? height >> 1 : height,
+            0,
+            GL_LUMINANCE,
+            GL_UNSIGNED_BYTE,
+            NULL);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    return ret;
+}
+
 void Gfx_TextureBind(GfxTexture* tex)
 {
-    glBindTexture(GL_TEXTURE_2D, tex->texID);
+    if (tex->isYUV) {
+        for (int p = 2; p >= 0; --p) {
+            glActiveTexture(GL_TEXTURE0 + p);
+            glBindTexture(GL_TEXTURE_2D, tex->planeIDs[p]);
+        }
+        glUseProgram(yuvProgram);
+    }
+    else {
+        glUseProgram(0);
+        glBindTexture(GL_TEXTURE_2D, tex->texID);
+    }
 }
 
 void Gfx_TextureUpload(GfxTexture* tex, void* pixels)
 {
+    if (tex->isYUV) {
+        // pixels is a planar IYUV frame: full size Y followed by quarter size U and V
+        unsigned char *plane = (unsigned char*)pixels;
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int p = 0; p < 3; ++p) {
+            int w = p ? tex->width >> 1 : tex->width;
+            int h = p ? tex->height >> 1 : tex->height;
+
+            glBindTexture(GL_TEXTURE_2D, tex->planeIDs[p]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_LUMINANCE, GL_UNSIGNED_BYTE, plane);
+            plane += w * h;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return;
+    }
+
     glBindTexture(GL_TEXTURE_2D, tex->texID);
     glTexSubImage2D(
         GL_TEXTURE_2D,
@@ -198,14 +355,20 @@ void Gfx_TextureUpload(GfxTexture* tex, void* pixels)
 
 void Gfx_TextureSetFilter(GfxTexture* tex, bool isLinear)
 {
-    glBindTexture(GL_TEXTURE_2D, tex->texID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, isLinear ? GL_LINEAR : GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, isLinear ? GL_LINEAR : GL_NEAREST);
+    int count = tex->isYUV ? 3 : 1;
+    for (int p = 0; p < count; ++p) {
+        glBindTexture(GL_TEXTURE_2D, tex->isYUV ? tex->planeIDs[p] : tex->texID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, isLinear ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, isLinear ? GL_LINEAR : GL_NEAREST);
+    }
 }
 
 void Gfx_TextureDestroy(GfxTexture* tex)
 {
-    glDeleteTextures(1, &tex->texID);
+    if (tex->isYUV)
+        glDeleteTextures(3, tex->planeIDs);
+    else
+        glDeleteTextures(1, &tex->texID);
     free(tex);
 }
 
@@ -49,3 +49,8 @@ unsigned long long Time_GetPerformanceCounter()
     }
     return counter.QuadPart;
 }
+
+void Time_Sleep(unsigned int ms)
+{
+    Sleep(ms);
+}
@@ -26,6 +26,8 @@ bool Gfx_MainLoop(GfxContext* ctx);
 bool Gfx_IsDevMenuTriggered(GfxContext* ctx);
 float Gfx_3DStrength();
 void Gfx_FrameBegin();
+// Pumps pending window/input events without starting a frame, used to refresh input after a late latch wait
+void Gfx_PollEvents();
 void Gfx_FrameEnd(GfxContext* ctx);
 void Gfx_Finalize(GfxContext* ctx);
 
@@ -39,6 +41,9 @@ void Gfx_DrawElements(int count, void* indices);
 
 // Texture functions
 GfxTexture* Gfx_TextureCreate(int width, int height, bool isRGB5A1, bool isVRAM);
+// Planar IYUV texture converted to RGB while drawing, Gfx_TextureUpload takes a whole IYUV frame.
+// Only used for FMV on GL backends, the 3DS decodes video through its own Video3DS path
+GfxTexture* Gfx_TextureCreateYUV(int width, int height);
 void Gfx_TextureBind(GfxTexture* tex);
 void Gfx_TextureUpload(GfxTexture* tex, void* pixels);
 void Gfx_TextureSetFilter(GfxTexture* tex, bool isLinear);
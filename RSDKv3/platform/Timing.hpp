@@ -7,4 +7,6 @@ unsigned int Time_GetTicks();
 unsigned long long Time_GetPerformanceFrequency();
 unsigned long long Time_GetPerformanceCounter();
 
+void Time_Sleep(unsigned int ms);
+
 #endif